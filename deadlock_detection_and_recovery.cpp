@@ -14,6 +14,36 @@
 #include <thread>       // Thread operations
 #include <mutex>        // Mutex operations
 #include <chrono>       // Time duration
+#include <atomic>       // Lock-free counters
+#include <memory>       // Shared snapshots
+#include <random>       // Per-thread random engines
+#include <cstdint>      // Fixed-width integers
+#include <cstring>      // Raw buffer copies
+#include <csignal>      // Server shutdown signals
+#include <sstream>      // Report formatting
+#include <list>         // LRU ordering
+#include <unordered_map> // Verdict cache index
+#include <unordered_set> // Probe bookkeeping
+#include <deque>        // Node inboxes
+#include <set>          // Cycle coverage checks
+#include <map>          // Fuzz timing table
+#include <condition_variable> // Journal group commit
+#include <cstdio>       // Journal and snapshot files
+#include <sys/stat.h>   // Journal directory creation
+#ifdef _WIN32
+#include <io.h>         // _commit
+#include <direct.h>     // _mkdir, _rmdir
+#else
+#include <unistd.h>     // fsync, rmdir
+#endif
+#ifdef __linux__
+#include <cerrno>       // Socket error codes
+#include <fcntl.h>      // Non-blocking sockets
+#include <unistd.h>     // read/write/close
+#include <sys/socket.h> // Unix domain sockets
+#include <sys/un.h>     // sockaddr_un
+#include <sys/epoll.h>  // Event loop
+#endif
 
 using namespace std;
 
@@ -204,6 +234,786 @@ void threadDeadlockMenu() {
     }
 }
 
+// ---------------------------------------------------------------------------
+// Instrumentation: per-thread counter/histogram shards, merged only when dumped
+// ---------------------------------------------------------------------------
+
+// Operation counters. The first six follow AdmissionResult order so a result maps directly.
+enum MetricCounter {
+    CTR_REQUESTS_GRANTED, CTR_DENIED_INVALID_PROCESS, CTR_DENIED_LENGTH_MISMATCH,
+    CTR_DENIED_EXCEEDS_NEED, CTR_DENIED_NOT_AVAILABLE, CTR_DENIED_UNSAFE, CTR_NOT_DURABLE,
+    CTR_DETECTIONS, CTR_DEADLOCKS_FOUND, CTR_VICTIMS_TERMINATED, CTR_UNITS_PREEMPTED,
+    CTR_VERDICT_CACHE_HITS, CTR_VERDICT_CACHE_MISSES,
+    CTR_COUNT
+};
+
+enum MetricTimer { TMR_REQUEST, TMR_SAFETY_CHECK, TMR_WFG_BUILD, TMR_CYCLE_SEARCH, TMR_REDUCTION, TMR_COUNT };
+
+const char* const kCounterNames[CTR_COUNT] = {
+    "requests_granted", "denied_invalid_process", "denied_length_mismatch",
+    "denied_exceeds_need", "denied_not_available", "denied_unsafe", "not_durable",
+    "detections", "deadlocks_found", "victims_terminated", "units_preempted",
+    "verdict_cache_hits", "verdict_cache_misses"
+};
+const char* const kTimerNames[TMR_COUNT] = { "request_resources", "safety_check", "wfg_build", "cycle_search", "graph_reduction" };
+
+atomic<bool> metricsEnabled(true);  // Instrumentation switch (checked once per timed scope)
+
+// Log-linear latency histogram in nanoseconds (HDR style): values below 16 get exact buckets,
+// larger values get 16 sub-buckets per power of two, so the relative error stays under 6.25%.
+// Each shard has a single writer, so updates are relaxed load+store rather than RMW.
+struct LatencyHistogram {
+    enum {
+        kSubBits = 4,
+        kSubBuckets = 1 << kSubBits,
+        kMaxExponent = 40,  // ~18 minutes; larger values land in the last bucket
+        kBuckets = kSubBuckets + (kMaxExponent - kSubBits + 1) * kSubBuckets
+    };
+
+    atomic<uint64_t> buckets[kBuckets];
+    atomic<uint64_t> count;
+    atomic<uint64_t> sum;
+    atomic<uint64_t> maxValue;
+
+    LatencyHistogram() : count(0), sum(0), maxValue(0) {
+        for (int b = 0; b < kBuckets; ++b) buckets[b].store(0, memory_order_relaxed);
+    }
+
+    static int bucketFor(uint64_t v) {
+        if (v < (uint64_t)kSubBuckets) return (int)v;
+        int exponent = 63 - __builtin_clzll(v);
+        if (exponent > kMaxExponent) return kBuckets - 1;
+        int sub = (int)((v >> (exponent - kSubBits)) & (kSubBuckets - 1));
+        return kSubBuckets + (exponent - kSubBits) * kSubBuckets + sub;
+    }
+
+    // Lower bound of a bucket's value range
+    static uint64_t bucketValue(int b) {
+        if (b < kSubBuckets) return (uint64_t)b;
+        int exponent = (b - kSubBuckets) / kSubBuckets + kSubBits;
+        uint64_t sub = (uint64_t)((b - kSubBuckets) % kSubBuckets);
+        return (1ull << exponent) | (sub << (exponent - kSubBits));
+    }
+
+    static void bump(atomic<uint64_t>& cell, uint64_t by) {
+        cell.store(cell.load(memory_order_relaxed) + by, memory_order_relaxed);
+    }
+
+    void record(uint64_t v) {
+        bump(buckets[bucketFor(v)], 1);
+        bump(count, 1);
+        bump(sum, v);
+        if (v > maxValue.load(memory_order_relaxed)) maxValue.store(v, memory_order_relaxed);
+    }
+
+    // Approximate value at quantile q (bucket lower bound, capped by the maximum)
+    uint64_t quantile(double q) const {
+        uint64_t total = count.load(memory_order_relaxed);
+        if (total == 0) return 0;
+        uint64_t rank = (uint64_t)(q * (total - 1)) + 1, seen = 0;
+        for (int b = 0; b < kBuckets; ++b) {
+            seen += buckets[b].load(memory_order_relaxed);
+            if (seen >= rank) return min(bucketValue(b), maxValue.load(memory_order_relaxed));
+        }
+        return maxValue.load(memory_order_relaxed);
+    }
+
+    // Add another histogram's contents (used when merging shards)
+    void mergeInto(vector<uint64_t>& totals, uint64_t& totalCount, uint64_t& totalSum, uint64_t& totalMax) const {
+        for (int b = 0; b < kBuckets; ++b) totals[b] += buckets[b].load(memory_order_relaxed);
+        totalCount += count.load(memory_order_relaxed);
+        totalSum += sum.load(memory_order_relaxed);
+        totalMax = max(totalMax, maxValue.load(memory_order_relaxed));
+    }
+};
+
+// One thread's metrics; written only by its owner, read by the dumper
+struct MetricsShard {
+    atomic<uint64_t> counters[CTR_COUNT];
+    LatencyHistogram timers[TMR_COUNT];
+
+    MetricsShard() { for (int c = 0; c < CTR_COUNT; ++c) counters[c].store(0, memory_order_relaxed); }
+};
+
+// Registry of live shards. Shards of exited threads are folded into `retired`.
+class MetricsRegistry {
+private:
+    mutex registryMutex;
+    vector<MetricsShard*> live;
+    vector<uint64_t> retiredCounters;
+    vector<vector<uint64_t>> retiredBuckets;
+    vector<uint64_t> retiredCount, retiredSum, retiredMax;
+
+public:
+    MetricsRegistry()
+        : retiredCounters(CTR_COUNT, 0), retiredBuckets(TMR_COUNT, vector<uint64_t>(LatencyHistogram::kBuckets, 0)),
+          retiredCount(TMR_COUNT, 0), retiredSum(TMR_COUNT, 0), retiredMax(TMR_COUNT, 0) {}
+
+    void attach(MetricsShard* shard) {
+        lock_guard<mutex> lock(registryMutex);
+        live.push_back(shard);
+    }
+
+    void retire(MetricsShard* shard) {
+        lock_guard<mutex> lock(registryMutex);
+        for (int c = 0; c < CTR_COUNT; ++c) retiredCounters[c] += shard->counters[c].load(memory_order_relaxed);
+        for (int t = 0; t < TMR_COUNT; ++t) {
+            shard->timers[t].mergeInto(retiredBuckets[t], retiredCount[t], retiredSum[t], retiredMax[t]);
+        }
+        live.erase(remove(live.begin(), live.end(), shard), live.end());
+    }
+
+    // Merge every shard and render the totals as plain text or JSON
+    string report(bool json) {
+        vector<uint64_t> counters, counts, sums, maxima;
+        vector<vector<uint64_t>> buckets;
+        {
+            lock_guard<mutex> lock(registryMutex);
+            counters = retiredCounters;
+            buckets = retiredBuckets;
+            counts = retiredCount; sums = retiredSum; maxima = retiredMax;
+            for (MetricsShard* shard : live) {
+                for (int c = 0; c < CTR_COUNT; ++c) counters[c] += shard->counters[c].load(memory_order_relaxed);
+                for (int t = 0; t < TMR_COUNT; ++t) shard->timers[t].mergeInto(buckets[t], counts[t], sums[t], maxima[t]);
+            }
+        }
+
+        const double quantiles[] = { 0.5, 0.9, 0.99, 0.999 };
+        const char* const quantileNames[] = { "p50", "p90", "p99", "p999" };
+        auto quantile = [&](int t, double q) -> uint64_t {
+            if (counts[t] == 0) return 0;
+            uint64_t rank = (uint64_t)(q * (counts[t] - 1)) + 1, seen = 0;
+            for (int b = 0; b < LatencyHistogram::kBuckets; ++b) {
+                seen += buckets[t][b];
+                if (seen >= rank) return min(LatencyHistogram::bucketValue(b), maxima[t]);
+            }
+            return maxima[t];
+        };
+
+        ostringstream out;
+        if (json) {
+            out << "{\"counters\":{";
+            for (int c = 0; c < CTR_COUNT; ++c) out << (c ? "," : "") << "\"" << kCounterNames[c] << "\":" << counters[c];
+            out << "},\"latency_ns\":{";
+            for (int t = 0; t < TMR_COUNT; ++t) {
+                out << (t ? "," : "") << "\"" << kTimerNames[t] << "\":{\"count\":" << counts[t]
+                    << ",\"mean\":" << (counts[t] ? sums[t] / counts[t] : 0);
+                for (int q = 0; q < 4; ++q) out << ",\"" << quantileNames[q] << "\":" << quantile(t, quantiles[q]);
+                out << ",\"max\":" << maxima[t] << "}";
+            }
+            out << "}}\n";
+        } else {
+            out << "========== DETECTOR STATISTICS ==========\n";
+            for (int c = 0; c < CTR_COUNT; ++c) out << left << setw(26) << kCounterNames[c] << right << counters[c] << "\n";
+            out << "\nLatency (ns)              count       mean        p50        p90        p99       p999        max\n";
+            for (int t = 0; t < TMR_COUNT; ++t) {
+                out << left << setw(20) << kTimerNames[t] << right << setw(11) << counts[t]
+                    << setw(11) << (counts[t] ? sums[t] / counts[t] : 0);
+                for (int q = 0; q < 4; ++q) out << setw(11) << quantile(t, quantiles[q]);
+                out << setw(11) << maxima[t] << "\n";
+            }
+            out << "==========================================\n";
+        }
+        return out.str();
+    }
+};
+
+MetricsRegistry& metricsRegistry() {
+    static MetricsRegistry* registry = new MetricsRegistry();  // Never destroyed: threads may retire during exit
+    return *registry;
+}
+
+// Owns the calling thread's shard and folds it into the registry when the thread exits
+struct ThreadMetrics {
+    MetricsShard shard;
+    ThreadMetrics() { metricsRegistry().attach(&shard); }
+    ~ThreadMetrics() { metricsRegistry().retire(&shard); }
+};
+
+MetricsShard& localMetrics() {
+    thread_local ThreadMetrics metrics;
+    return metrics.shard;
+}
+
+void countMetric(MetricCounter counter, uint64_t by = 1) {
+    if (!metricsEnabled.load(memory_order_relaxed)) return;
+    LatencyHistogram::bump(localMetrics().counters[counter], by);
+}
+
+// Records the lifetime of a scope into one latency histogram
+class ScopedLatency {
+private:
+    MetricTimer timer;
+    bool active;
+    chrono::steady_clock::time_point start;
+
+public:
+    explicit ScopedLatency(MetricTimer t) : timer(t), active(metricsEnabled.load(memory_order_relaxed)) {
+        if (active) start = chrono::steady_clock::now();
+    }
+    ~ScopedLatency() {
+        if (!active) return;
+        auto elapsed = chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count();
+        localMetrics().timers[timer].record((uint64_t)elapsed);
+    }
+};
+
+// 128-bit Zobrist-style fingerprint of (available, allocation, need): the XOR of a keyed mix of
+// every cell, so changing one cell updates it in O(1) and changing a process row in O(m)
+struct StateHash {
+    uint64_t lo;
+    uint64_t hi;
+    bool operator==(const StateHash& other) const { return lo == other.lo && hi == other.hi; }
+};
+
+struct StateHashHasher {
+    size_t operator()(const StateHash& h) const { return (size_t)(h.lo ^ (h.hi >> 7)); }
+};
+
+enum StateCell { CELL_SHAPE = 1, CELL_AVAILABLE = 2, CELL_ALLOCATION = 3, CELL_NEED = 4 };
+
+inline uint64_t splitMix64(uint64_t x) {
+    x += 0x9E3779B97F4A7C15ull;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    return x ^ (x >> 31);
+}
+
+// XOR one cell's contribution in or out (toggling twice cancels it)
+inline void toggleCell(StateHash& h, StateCell kind, int i, int j, int value) {
+    uint64_t id = ((uint64_t)kind << 56) ^ ((uint64_t)(uint32_t)i << 28) ^ (uint64_t)(uint32_t)j;
+    uint64_t v = (uint64_t)(uint32_t)value;
+    h.lo ^= splitMix64(id * 0xD6E8FEB86659FD93ull ^ v);
+    h.hi ^= splitMix64((id + 0x632BE59BD9B4E019ull) ^ (v * 0xC2B2AE3D27D4EB4Full));
+}
+
+inline void changeCell(StateHash& h, StateCell kind, int i, int j, int oldValue, int newValue) {
+    if (oldValue == newValue) return;
+    toggleCell(h, kind, i, j, oldValue);
+    toggleCell(h, kind, i, j, newValue);
+}
+
+// Full O(nm) fingerprint, used when a whole state is loaded
+StateHash hashState(const vector<int>& available, const vector<vector<int>>& allocation,
+                    const vector<vector<int>>& need) {
+    StateHash h = { 0, 0 };
+    int numProcesses = (int)allocation.size(), numResources = (int)available.size();
+    toggleCell(h, CELL_SHAPE, numProcesses, numResources, 0);
+    for (int j = 0; j < numResources; ++j) toggleCell(h, CELL_AVAILABLE, 0, j, available[j]);
+    for (int i = 0; i < numProcesses; ++i) {
+        for (int j = 0; j < numResources; ++j) {
+            toggleCell(h, CELL_ALLOCATION, i, j, allocation[i][j]);
+            toggleCell(h, CELL_NEED, i, j, need[i][j]);
+        }
+    }
+    return h;
+}
+
+// Fingerprint of the state after granting grantVec to one process, in O(m)
+StateHash hashWithGrant(StateHash h, const vector<int>& available, const vector<vector<int>>& allocation,
+                        const vector<vector<int>>& need, int processId, const vector<int>& grantVec) {
+    for (int j = 0; j < (int)available.size(); ++j) {
+        int d = grantVec[j];
+        if (d == 0) continue;
+        changeCell(h, CELL_AVAILABLE, 0, j, available[j], available[j] - d);
+        changeCell(h, CELL_ALLOCATION, processId, j, allocation[processId][j], allocation[processId][j] + d);
+        changeCell(h, CELL_NEED, processId, j, need[processId][j], need[processId][j] - d);
+    }
+    return h;
+}
+
+// Bounded LRU memo of safety verdicts (and safe sequences) keyed by state fingerprint
+class VerdictCache {
+private:
+    struct Entry {
+        StateHash key;
+        bool safe;
+        vector<int> safeSequence;
+    };
+
+    mutex cacheMutex;
+    size_t capacity;
+    list<Entry> lru;                                                     // Most recent first
+    unordered_map<StateHash, list<Entry>::iterator, StateHashHasher> index;
+    atomic<uint64_t> hits;
+    atomic<uint64_t> misses;
+
+public:
+    explicit VerdictCache(size_t maxEntries) : capacity(max<size_t>(1, maxEntries)), hits(0), misses(0) {}
+
+    bool lookup(const StateHash& key, bool& safe, vector<int>& safeSequence) {
+        lock_guard<mutex> lock(cacheMutex);
+        auto it = index.find(key);
+        if (it == index.end()) { misses++; countMetric(CTR_VERDICT_CACHE_MISSES); return false; }
+        lru.splice(lru.begin(), lru, it->second);
+        safe = it->second->safe;
+        safeSequence = it->second->safeSequence;
+        hits++;
+        countMetric(CTR_VERDICT_CACHE_HITS);
+        return true;
+    }
+
+    void store(const StateHash& key, bool safe, const vector<int>& safeSequence) {
+        lock_guard<mutex> lock(cacheMutex);
+        auto it = index.find(key);
+        if (it != index.end()) { lru.splice(lru.begin(), lru, it->second); return; }
+        Entry entry = { key, safe, safeSequence };
+        lru.push_front(entry);
+        index[key] = lru.begin();
+        if (lru.size() > capacity) {
+            index.erase(lru.back().key);
+            lru.pop_back();
+        }
+    }
+
+    string report() {
+        lock_guard<mutex> lock(cacheMutex);
+        uint64_t h = hits.load(), m = misses.load();
+        ostringstream out;
+        out << "Verdict cache: " << lru.size() << "/" << capacity << " entries, " << h << " hits, " << m
+            << " misses, hit rate " << fixed << setprecision(1) << (h + m ? 100.0 * h / (h + m) : 0.0) << "%\n";
+        return out.str();
+    }
+};
+
+// Immutable copy of the detector state, published copy-on-write for readers
+struct StateSnapshot {
+    uint64_t version;                    // State version the copy was taken at
+    uint64_t grantEpoch;                 // Grant epoch the copy was taken at
+    int numProcesses;                    // Number of processes in system
+    int numResources;                    // Number of resource types
+    vector<int> available;               // Available instances of each resource
+    vector<vector<int>> maximum;         // Maximum resource needs per process
+    vector<vector<int>> allocation;      // Currently allocated resources
+    vector<vector<int>> need;            // Remaining resource needs
+    vector<vector<int>> request;         // Outstanding (blocked) requests
+    StateHash hash;                      // Fingerprint of available/allocation/need
+    uint64_t journalLsn;                 // Last journal record reflected in the copy (0 without a journal)
+};
+
+// Write-ahead journal record kinds. A LOAD record carries a whole state and doubles as the
+// snapshot file format.
+enum JournalRecordType : uint8_t { REC_GRANT = 1, REC_RELEASE = 2, REC_RECLAIM = 3, REC_REQUEST_ROW = 4, REC_LOAD = 5,
+                                   REC_MAXIMUM_ROW = 6 };
+enum JournalRecordFlag : uint8_t { REC_SPARSE = 1, REC_WHOLE_ROW = 2, REC_EXIT = 4 };
+
+// Fixed header in front of every journal record's int32 values
+struct JournalRecordHeader {
+    uint64_t lsn;        // Log sequence number, consecutive from 1
+    uint32_t checksum;   // FNV-1a over header (checksum = 0) and values; detects torn writes
+    uint32_t count;      // Number of int32 values that follow
+    int32_t processId;   // Target process; in a snapshot file, the first journal segment of the tail
+    uint8_t type;        // JournalRecordType
+    uint8_t flags;       // JournalRecordFlag bits
+    uint16_t reserved;   // Always 0
+};
+
+// How long a committing caller waits for its journal records
+enum class JournalMode {
+    Async,   // The flusher writes and syncs every interval; a crash can lose at most that window
+    Sync     // Callers wait until their records are synced; concurrent commits share one sync
+};
+
+uint32_t fnv1a(uint32_t hash, const void* data, size_t length) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < length; ++i) { hash ^= bytes[i]; hash *= 16777619u; }
+    return hash;
+}
+
+// Append one record (header plus values) to a byte buffer
+void encodeJournalRecord(string& out, uint64_t lsn, uint8_t type, int32_t processId, uint8_t flags,
+                         const vector<int32_t>& values) {
+    JournalRecordHeader header = {};
+    header.lsn = lsn;
+    header.count = (uint32_t)values.size();
+    header.processId = processId;
+    header.type = type;
+    header.flags = flags;
+    uint32_t checksum = fnv1a(2166136261u, &header, sizeof(header));
+    header.checksum = fnv1a(checksum, values.data(), values.size() * sizeof(int32_t));
+    out.append(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.append(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(int32_t));
+}
+
+// Read the next record from a file; false at end of file or on a torn/corrupt record
+bool readJournalRecord(FILE* file, JournalRecordHeader& header, vector<int32_t>& values) {
+    if (fread(&header, sizeof(header), 1, file) != 1) return false;
+    if (header.count > (1u << 28)) return false;
+    values.resize(header.count);
+    if (header.count > 0 && fread(values.data(), sizeof(int32_t), header.count, file) != header.count) return false;
+    uint32_t expected = header.checksum;
+    header.checksum = 0;
+    uint32_t checksum = fnv1a(fnv1a(2166136261u, &header, sizeof(header)), values.data(), values.size() * sizeof(int32_t));
+    header.checksum = expected;
+    return checksum == expected;
+}
+
+// Journal values for a vector: dense, or (size, index, value...) when mostly zero
+uint8_t packJournalVector(const vector<int>& vec, vector<int32_t>& values) {
+    size_t nonZero = 0;
+    for (int v : vec) if (v != 0) nonZero++;
+    values.clear();
+    if (2 * nonZero >= vec.size()) {
+        values.assign(vec.begin(), vec.end());
+        return 0;
+    }
+    values.push_back((int32_t)vec.size());
+    for (size_t j = 0; j < vec.size(); ++j) {
+        if (vec[j] != 0) { values.push_back((int32_t)j); values.push_back(vec[j]); }
+    }
+    return REC_SPARSE;
+}
+
+bool unpackJournalVector(const JournalRecordHeader& header, const vector<int32_t>& values, vector<int>& vec) {
+    if (!(header.flags & REC_SPARSE)) { vec.assign(values.begin(), values.end()); return true; }
+    if (values.empty() || values[0] < 0 || values.size() % 2 != 1) return false;
+    vec.assign(values[0], 0);
+    for (size_t k = 1; k < values.size(); k += 2) {
+        if (values[k] < 0 || values[k] >= values[0]) return false;
+        vec[values[k]] = values[k + 1];
+    }
+    return true;
+}
+
+// Flatten a whole state into LOAD record values: p, r, available, maximum, allocation, need, request,
+// then (snapshots only) one flag per process marking the slots freed by exits
+void packJournalState(int p, int r, const vector<int>& available, const vector<vector<int>>& maximum,
+                      const vector<vector<int>>& allocation, const vector<vector<int>>& need,
+                      const vector<vector<int>>& request, vector<int32_t>& values,
+                      const vector<bool>* exited = nullptr) {
+    values.clear();
+    values.reserve(2 + r + 4 * (size_t)p * r + (exited ? p : 0));
+    values.push_back(p);
+    values.push_back(r);
+    values.insert(values.end(), available.begin(), available.end());
+    const vector<vector<int>>* matrices[] = { &maximum, &allocation, &need, &request };
+    for (const vector<vector<int>>* mat : matrices) {
+        for (const vector<int>& row : *mat) values.insert(values.end(), row.begin(), row.end());
+    }
+    if (exited) values.insert(values.end(), exited->begin(), exited->end());
+}
+
+bool syncFile(FILE* file) {
+    if (fflush(file) != 0) return false;
+#ifdef _WIN32
+    return _commit(_fileno(file)) == 0;
+#else
+    return fsync(fileno(file)) == 0;
+#endif
+}
+
+bool makeDirectory(const string& path) {
+#ifdef _WIN32
+    return _mkdir(path.c_str()) == 0 || errno == EEXIST;
+#else
+    return mkdir(path.c_str(), 0755) == 0 || errno == EEXIST;
+#endif
+}
+
+// Remove an empty directory
+bool removeDirectory(const string& path) {
+#ifdef _WIN32
+    return _rmdir(path.c_str()) == 0;
+#else
+    return rmdir(path.c_str()) == 0;
+#endif
+}
+
+string journalSegmentPath(const string& directory, uint64_t segment) {
+    char name[40];
+    snprintf(name, sizeof(name), "/journal.%08llu.log", (unsigned long long)segment);
+    return directory + name;
+}
+
+string journalSnapshotPath(const string& directory) { return directory + "/snapshot.bin"; }
+
+// Append-only journal split into numbered segment files. Records are encoded into a memory
+// buffer by the committing thread; a flusher thread writes whatever has accumulated with one
+// write and one sync, so concurrent commits share the cost (group commit). A checkpoint
+// starts a new segment so that older ones can be dropped once the snapshot covers them.
+class StateJournal {
+private:
+    static const size_t kSegmentBytes = 16u << 20;  // Start a new segment beyond this size
+
+    string directory;
+    JournalMode mode;
+    chrono::milliseconds flushInterval;
+
+    mutable mutex journalMutex;
+    condition_variable flushNeeded;      // Wakes the flusher early (sync waiters, shutdown)
+    condition_variable flushed;          // Signalled after every flush
+    string pending;                      // Encoded records not yet written
+    vector<size_t> cuts;                 // Offsets in pending where a new segment starts
+    uint64_t appended;                   // Highest LSN handed to the journal
+    uint64_t durable;                    // Highest LSN synced to disk
+    uint64_t tailSegment;                // Segment the next appended record lands in
+    size_t tailBytes;                    // Bytes already assigned to tailSegment
+    uint64_t openSegment;                // Segment the flusher has open
+    uint64_t oldestSegment;              // Oldest segment still on disk
+    uint64_t syncCount;                  // Flushes performed
+    int syncWaiters;
+    bool stopping;
+    bool failed;
+
+    FILE* segmentFile;                   // Owned by the flusher thread
+    thread flusher;
+
+    bool writeChunk(const string& chunk, const vector<size_t>& chunkCuts) {
+        size_t pos = 0;
+        for (size_t cut : chunkCuts) {
+            if (cut > pos && fwrite(chunk.data() + pos, 1, cut - pos, segmentFile) != cut - pos) return false;
+            if (!syncFile(segmentFile)) return false;
+            fclose(segmentFile);
+            segmentFile = fopen(journalSegmentPath(directory, openSegment + 1).c_str(), "ab");
+            if (!segmentFile) return false;
+            lock_guard<mutex> lock(journalMutex);
+            openSegment++;
+            pos = cut;
+        }
+        if (chunk.size() > pos && fwrite(chunk.data() + pos, 1, chunk.size() - pos, segmentFile) != chunk.size() - pos) return false;
+        return syncFile(segmentFile);
+    }
+
+    void flushLoop() {
+        unique_lock<mutex> lock(journalMutex);
+        while (true) {
+            flushNeeded.wait_for(lock, flushInterval, [&]() {
+                return stopping || (syncWaiters > 0 && (!pending.empty() || !cuts.empty()));
+            });
+            if (pending.empty() && cuts.empty()) {
+                if (stopping) break;
+                continue;
+            }
+            string chunk;
+            vector<size_t> chunkCuts;
+            chunk.swap(pending);
+            chunkCuts.swap(cuts);
+            uint64_t upTo = appended;
+            lock.unlock();
+            bool ok = !failed && writeChunk(chunk, chunkCuts);
+            lock.lock();
+            if (ok) durable = upTo; else failed = true;
+            syncCount++;
+            flushed.notify_all();
+        }
+        flushed.notify_all();
+    }
+
+public:
+    StateJournal(const string& dir, JournalMode journalMode, int flushIntervalMs)
+        : directory(dir), mode(journalMode), flushInterval(max(1, flushIntervalMs)), appended(0), durable(0),
+          tailSegment(1), tailBytes(0), openSegment(1), oldestSegment(1), syncCount(0), syncWaiters(0),
+          stopping(false), failed(false), segmentFile(nullptr) {}
+
+    ~StateJournal() { stop(); }
+
+    // Start writing at the given segment (always a fresh file) and LSN
+    bool start(uint64_t firstSegment, uint64_t oldest, uint64_t lastLsn) {
+        segmentFile = fopen(journalSegmentPath(directory, firstSegment).c_str(), "ab");
+        if (!segmentFile) return false;
+        tailSegment = openSegment = firstSegment;
+        oldestSegment = oldest;
+        appended = durable = lastLsn;
+        flusher = thread(&StateJournal::flushLoop, this);
+        return true;
+    }
+
+    // Flush everything and stop the flusher
+    void stop() {
+        {
+            lock_guard<mutex> lock(journalMutex);
+            stopping = true;
+        }
+        flushNeeded.notify_one();
+        if (flusher.joinable()) flusher.join();
+        if (segmentFile) { fclose(segmentFile); segmentFile = nullptr; }
+    }
+
+    // Buffer a record; returns its LSN. Callers hold the detector's state lock, so LSN order
+    // is commit order.
+    uint64_t append(uint8_t type, int32_t processId, uint8_t flags, const vector<int32_t>& values) {
+        lock_guard<mutex> lock(journalMutex);
+        uint64_t lsn = ++appended;
+        size_t before = pending.size();
+        encodeJournalRecord(pending, lsn, type, processId, flags, values);
+        tailBytes += pending.size() - before;
+        if (tailBytes >= kSegmentBytes) {
+            cuts.push_back(pending.size());
+            tailSegment++;
+            tailBytes = 0;
+        }
+        return lsn;
+    }
+
+    // End the current segment after the last appended record; returns the next segment
+    uint64_t rotate() {
+        lock_guard<mutex> lock(journalMutex);
+        cuts.push_back(pending.size());
+        tailBytes = 0;
+        return ++tailSegment;
+    }
+
+    // Block until every record up to lsn is synced and the flusher has reached segment;
+    // false if the journal failed
+    bool waitFlushed(uint64_t lsn, uint64_t segment = 0) {
+        unique_lock<mutex> lock(journalMutex);
+        if (failed) return false;
+        if (durable >= lsn && openSegment >= segment) return true;
+        syncWaiters++;
+        flushNeeded.notify_one();
+        flushed.wait(lock, [&]() { return failed || (durable >= lsn && openSegment >= segment) || (stopping && pending.empty()); });
+        syncWaiters--;
+        return !failed && durable >= lsn;
+    }
+
+    // Delete segments older than the given one (their records are covered by a snapshot)
+    void removeSegmentsBefore(uint64_t segment) {
+        lock_guard<mutex> lock(journalMutex);
+        for (; oldestSegment < segment; ++oldestSegment) remove(journalSegmentPath(directory, oldestSegment).c_str());
+    }
+
+    uint64_t appendedLsn() const { lock_guard<mutex> lock(journalMutex); return appended; }
+    const string& directoryPath() const { return directory; }
+    bool syncOnCommit() const { return mode == JournalMode::Sync; }
+
+    string report() const {
+        lock_guard<mutex> lock(journalMutex);
+        ostringstream out;
+        out << "Journal: " << directory << " (" << (mode == JournalMode::Sync ? "sync" : "async") << "), last LSN "
+            << appended << ", durable " << durable << ", " << syncCount << " flushes, segments " << oldestSegment
+            << "-" << tailSegment << (failed ? ", WRITE FAILED" : "") << "\n";
+        return out.str();
+    }
+};
+
+// Outcome of a quiet (non-interactive) admission attempt
+// NotDurable: the change was applied but the journal failed to make it durable (sync mode)
+enum class AdmissionResult { Granted, InvalidProcess, LengthMismatch, ExceedsNeed, NotAvailable, Unsafe, NotDurable };
+
+const char* admissionResultName(AdmissionResult result) {
+    switch (result) {
+        case AdmissionResult::Granted:        return "granted";
+        case AdmissionResult::InvalidProcess: return "invalid_process";
+        case AdmissionResult::LengthMismatch: return "length_mismatch";
+        case AdmissionResult::ExceedsNeed:    return "exceeds_need";
+        case AdmissionResult::NotAvailable:   return "not_available";
+        case AdmissionResult::Unsafe:         return "unsafe";
+        case AdmissionResult::NotDurable:     return "not_durable";
+    }
+    return "unknown";
+}
+
+// Banker's safety pass over an explicit state. When grantProcess >= 0, grantVec is treated
+// as already allocated to that process, so a request can be checked without copying matrices.
+bool computeSafeSequence(const vector<int>& available, const vector<vector<int>>& allocation,
+                         const vector<vector<int>>& need, vector<int>& safeSequence,
+                         const vector<bool>* terminatedProcesses = nullptr,
+                         int grantProcess = -1, const vector<int>* grantVec = nullptr) {
+    ScopedLatency timing(TMR_SAFETY_CHECK);
+    int numProcesses = (int)allocation.size();
+    int numResources = (int)available.size();
+    vector<int> work = available;
+    vector<bool> finish(numProcesses, false);
+    safeSequence.clear();
+    if (grantProcess >= 0) {
+        for (int j = 0; j < numResources; ++j) work[j] -= (*grantVec)[j];
+    }
+    int active = numProcesses;
+    if (terminatedProcesses != nullptr) {
+        for (int i = 0; i < numProcesses; ++i) if ((*terminatedProcesses)[i]) { finish[i] = true; active--; }
+    }
+    int count = 0;
+    while (count < active) {
+        bool found = false;
+        for (int i = 0; i < numProcesses; ++i) if (!finish[i]) {
+            bool canFinish = true;
+            if (i == grantProcess) {
+                for (int j = 0; j < numResources; ++j) if (need[i][j] - (*grantVec)[j] > work[j]) { canFinish = false; break; }
+            } else {
+                for (int j = 0; j < numResources; ++j) if (need[i][j] > work[j]) { canFinish = false; break; }
+            }
+            if (canFinish) {
+                for (int j = 0; j < numResources; ++j) work[j] += allocation[i][j];
+                if (i == grantProcess) for (int j = 0; j < numResources; ++j) work[j] += (*grantVec)[j];
+                finish[i] = true; safeSequence.push_back(i); found = true; count++;
+            }
+        }
+        if (!found) return false; // unsafe
+    }
+    return true;
+}
+
+// Re-check a safe sequence found on an older state against the current one in a single
+// O(nm) pass. Cheaper than a fresh search, so optimistic admissions validate with it.
+bool verifySafeSequence(const vector<int>& available, const vector<vector<int>>& allocation,
+                        const vector<vector<int>>& need, const vector<int>& safeSequence,
+                        int grantProcess = -1, const vector<int>* grantVec = nullptr) {
+    int numProcesses = (int)allocation.size();
+    int numResources = (int)available.size();
+    if ((int)safeSequence.size() != numProcesses) return false;
+    vector<int> work = available;
+    if (grantProcess >= 0) {
+        for (int j = 0; j < numResources; ++j) work[j] -= (*grantVec)[j];
+    }
+    for (int i : safeSequence) {
+        if (i < 0 || i >= numProcesses) return false;
+        int granted = 0;
+        for (int j = 0; j < numResources; ++j) {
+            if (i == grantProcess) granted = (*grantVec)[j];
+            if (need[i][j] - granted > work[j]) return false;
+        }
+        for (int j = 0; j < numResources; ++j) {
+            work[j] += allocation[i][j] + (i == grantProcess ? (*grantVec)[j] : 0);
+        }
+    }
+    return true;
+}
+
+// Wait-for edges from outstanding requests: process i waits for every other holder of a
+// resource whose request it cannot currently get
+vector<vector<int>> buildWaitEdges(const StateSnapshot& s) {
+    vector<vector<int>> edges(s.numProcesses);
+    vector<vector<int>> holders(s.numResources);
+    for (int i = 0; i < s.numProcesses; ++i) {
+        for (int j = 0; j < s.numResources; ++j) if (s.allocation[i][j] > 0) holders[j].push_back(i);
+    }
+    for (int i = 0; i < s.numProcesses; ++i) {
+        for (int j = 0; j < s.numResources; ++j) {
+            if (s.request[i][j] <= s.available[j]) continue;
+            for (int h : holders[j]) if (h != i) edges[i].push_back(h);
+        }
+        sort(edges[i].begin(), edges[i].end());
+        edges[i].erase(unique(edges[i].begin(), edges[i].end()), edges[i].end());
+    }
+    return edges;
+}
+
+// Strongly connected components (Tarjan). Returns each process's component id, or -1 for
+// processes that are not on any cycle.
+vector<int> processesOnCycles(const vector<vector<int>>& edges) {
+    int n = (int)edges.size(), counter = 0, components = 0;
+    vector<int> index(n, -1), low(n, 0), component(n, -1), stack;
+    vector<bool> onStack(n, false);
+    function<void(int)> connect = [&](int v) {
+        index[v] = low[v] = counter++;
+        stack.push_back(v); onStack[v] = true;
+        for (int u : edges[v]) {
+            if (index[u] < 0) { connect(u); low[v] = min(low[v], low[u]); }
+            else if (onStack[u]) low[v] = min(low[v], index[u]);
+        }
+        if (low[v] != index[v]) return;
+        vector<int> members;
+        int u;
+        do { u = stack.back(); stack.pop_back(); onStack[u] = false; members.push_back(u); } while (u != v);
+        if (members.size() > 1) {
+            for (int m : members) component[m] = components;
+            components++;
+        }
+    };
+    for (int v = 0; v < n; ++v) if (index[v] < 0) connect(v);
+    return component;
+}
+
 // Main class for Banker's Algorithm and Wait-For Graph deadlock detection
 class DeadlockDetector {
 private:
@@ -216,593 +1026,3824 @@ private:
     vector<vector<int>> maximum;         // Maximum resource needs per process
     vector<vector<int>> allocation;      // Currently allocated resources
     vector<vector<int>> need;            // Remaining resource needs
+    vector<vector<int>> request;         // Outstanding requests processes are blocked on (not need)
+    vector<bool> exited;                 // Slots freed by removeProcess, reused by addProcess
+    StateHash stateHash;                 // Incrementally maintained fingerprint of the matrices
 
-    // Calculate need matrix: Need = Maximum - Allocation
-    void calculateNeed() {
-        need.assign(numProcesses, vector<int>(numResources, 0));
-        for (int i = 0; i < numProcesses; ++i) {
-            for (int j = 0; j < numResources; ++j) {
-                need[i][j] = maximum[i][j] - allocation[i][j];
-                if (need[i][j] < 0) need[i][j] = 0; // Safety check
+    // Concurrency control: commits serialize on stateMutex, readers use published snapshots
+    mutable recursive_mutex stateMutex;              // Guards the matrices above
+    atomic<uint64_t> stateVersion;                   // Bumped by every committed change
+    atomic<uint64_t> grantEpoch;                     // Bumped only by changes that can make a safe state unsafe
+    mutable shared_ptr<const StateSnapshot> publishedSnapshot;  // Latest snapshot (atomic_load/atomic_store only)
+    shared_ptr<StateSnapshot> lastPublished, spareSnapshot;     // Publisher's own references (under stateMutex)
+    vector<uint64_t> rowChangedAt;                   // Per process: version of the commit that publishes its last change
+    uint64_t reshapedAt;                             // Version of the commit that publishes the last whole-state change
+    shared_ptr<VerdictCache> verdictCache;           // Optional memo of safety verdicts (atomic_load/atomic_store only)
+    shared_ptr<StateJournal> journal;                // Optional write-ahead journal (stored under stateMutex; atomic_load outside it)
+
+    // Background checkpoints of an open journal
+    mutex checkpointMutex;                           // Serializes checkpoints
+    condition_variable checkpointWake;
+    thread checkpointThread;
+    bool checkpointStop;
+    uint64_t checkpointEvery;                        // Records between background snapshots
+    atomic<uint64_t> checkpointedLsn;                // LSN covered by the latest snapshot
+    string recoveryReport;                           // What the last openJournal recovered
+
+    static const int kOptimisticAttempts = 4;        // Snapshot-validated tries before admitting under the lock
+
+    // Publish a committed change: the new immutable snapshot is built here, once per commit,
+    // so readers only ever load a pointer. Grants and reloads may reduce safety; releases and
+    // recovery only return resources, which can never turn a safe state unsafe.
+    void commitLocked(bool mayReduceSafety) {
+        if (mayReduceSafety) grantEpoch.fetch_add(1);
+        stateVersion.fetch_add(1);
+        publishLocked();
+    }
+
+    // Mark a process's rows (or the whole state) as changed by the commit in progress
+    void touchRow(int processId) {
+        if ((int)rowChangedAt.size() < numProcesses) rowChangedAt.resize(numProcesses, 0);
+        rowChangedAt[processId] = stateVersion.load() + 1;
+    }
+    void touchAll() {
+        rowChangedAt.assign(numProcesses, 0);
+        reshapedAt = stateVersion.load() + 1;
+    }
+
+    // Copy the state into a snapshot built at version `from`; only rows changed since then are
+    // copied unless the shape changed (from == 0 forces a full copy)
+    void fillSnapshotLocked(StateSnapshot& s, uint64_t from) const {
+        bool full = from == 0 || reshapedAt > from || s.numProcesses != numProcesses || s.numResources != numResources;
+        s.version = stateVersion.load();
+        s.grantEpoch = grantEpoch.load();
+        s.numProcesses = numProcesses;
+        s.numResources = numResources;
+        s.available = available;
+        if (full) {
+            s.maximum = maximum;
+            s.allocation = allocation;
+            s.need = need;
+            s.request = request;
+        } else {
+            for (int i = 0; i < numProcesses; ++i) {
+                if (rowChangedAt[i] <= from) continue;
+                s.maximum[i] = maximum[i];
+                s.allocation[i] = allocation[i];
+                s.need[i] = need[i];
+                s.request[i] = request[i];
             }
         }
+        s.hash = stateHash;
+        s.journalLsn = journal ? journal->appendedLsn() : 0;
+    }
+
+    // Publish the committed state. Snapshots are double-buffered: the one published before the
+    // current one can no longer be loaded by readers, so once its use count drops to one it is
+    // patched in place and a commit copies only the rows it changed instead of all O(nm) cells.
+    void publishLocked() {
+        shared_ptr<StateSnapshot> next;
+        uint64_t from = 0;
+        if (spareSnapshot && spareSnapshot.use_count() == 1) {
+            atomic_thread_fence(memory_order_acquire);  // Pairs with the last reader's release
+            next = spareSnapshot;
+            from = next->version;
+        } else {
+            next = make_shared<StateSnapshot>();
+        }
+        fillSnapshotLocked(*next, from);
+        spareSnapshot = lastPublished;
+        lastPublished = next;
+        atomic_store(&publishedSnapshot, shared_ptr<const StateSnapshot>(next));
+    }
+
+    // Declared before the state lock in mutating calls, which call wait() once the lock has
+    // been released: in Sync mode it blocks until the call's journal records are synced (so
+    // group commit never holds the lock) and returns false if the journal failed, which the
+    // call reports. Records are charged to the innermost scope on the appending thread, so a
+    // caller waits for its own LSN and not for records other threads appended after it. A
+    // nested scope hands its LSN to the enclosing one, which waits for both.
+    struct DurableScope {
+        const DeadlockDetector& owner;
+        uint64_t lsn;                            // Highest LSN appended within this scope
+        DurableScope* outer;
+        bool closed;
+        static DurableScope*& active() {
+            static thread_local DurableScope* scope = nullptr;
+            return scope;
+        }
+        explicit DurableScope(const DeadlockDetector& detector)
+            : owner(detector), lsn(0), outer(active()), closed(false) { active() = this; }
+        ~DurableScope() { close(); }
+
+        // True once the records are durable, or handed to an enclosing scope, or need no sync
+        bool wait() {
+            if (!close() || lsn == 0) return true;
+            shared_ptr<StateJournal> j = atomic_load(&owner.journal);
+            return !j || !j->syncOnCommit() || j->waitFlushed(lsn);
+        }
+
+    private:
+        // Leave the scope; returns whether this scope still owes the wait
+        bool close() {
+            if (closed) return false;
+            closed = true;
+            active() = outer;
+            if (outer == nullptr || &outer->owner != &owner) return true;
+            outer->lsn = max(outer->lsn, lsn);
+            return false;
+        }
+    };
+
+    // Append a record (journal must be open) and charge it to the caller's DurableScope
+    void appendJournal(uint8_t type, int32_t processId, uint8_t flags, const vector<int32_t>& values) {
+        uint64_t lsn = journal->append(type, processId, flags, values);
+        DurableScope* scope = DurableScope::active();
+        if (scope != nullptr && &scope->owner == this) scope->lsn = lsn;
+    }
+
+    // Journal one vector-valued mutation (no-op without a journal)
+    void journalVector(uint8_t type, int processId, const vector<int>& vec, uint8_t extraFlags = 0) {
+        if (!journal) return;
+        vector<int32_t> values;
+        uint8_t flags = packJournalVector(vec, values) | extraFlags;
+        appendJournal(type, processId, flags, values);
+    }
+
+    // A loader replaced the whole state: journal it as one LOAD record and publish
+    void commitReloadLocked() {
+        touchAll();
+        exited.assign(numProcesses, false);
+        if (journal) {
+            vector<int32_t> values;
+            packJournalState(numProcesses, numResources, available, maximum, allocation, need, request, values);
+            appendJournal(REC_LOAD, -1, 0, values);
+        }
+        commitLocked(true);
+    }
+
+    // Move a vector of units between available and a process (sign +1 grants, -1 releases)
+    void adjustAllocation(int processId, const vector<int>& delta, int sign) {
+        journalVector(sign > 0 ? REC_GRANT : REC_RELEASE, processId, delta);
+        applyAllocation(processId, delta, sign);
+    }
+
+    // adjustAllocation without the journal record, for tentative changes that may be undone
+    void applyAllocation(int processId, const vector<int>& delta, int sign) {
+        touchRow(processId);
+        for (int j = 0; j < numResources; ++j) {
+            if (delta[j] == 0) continue;
+            changeCell(stateHash, CELL_AVAILABLE, 0, j, available[j], available[j] - sign * delta[j]);
+            changeCell(stateHash, CELL_ALLOCATION, processId, j, allocation[processId][j], allocation[processId][j] + sign * delta[j]);
+            changeCell(stateHash, CELL_NEED, processId, j, need[processId][j], need[processId][j] - sign * delta[j]);
+            available[j] -= sign * delta[j];
+            allocation[processId][j] += sign * delta[j];
+            need[processId][j] -= sign * delta[j];
+        }
+    }
+
+    // Return a process's held units to the pool and clear its need (termination), or only
+    // for the resources it actually holds (preemption)
+    void reclaimFromProcess(int processId, bool wholeRow) {
+        touchRow(processId);
+        if (journal) appendJournal(REC_RECLAIM, processId, wholeRow ? REC_WHOLE_ROW : 0, vector<int32_t>());
+        for (int j = 0; j < numResources; ++j) {
+            if (!wholeRow && allocation[processId][j] == 0) continue;
+            changeCell(stateHash, CELL_AVAILABLE, 0, j, available[j], available[j] + allocation[processId][j]);
+            changeCell(stateHash, CELL_ALLOCATION, processId, j, allocation[processId][j], 0);
+            changeCell(stateHash, CELL_NEED, processId, j, need[processId][j], 0);
+            available[j] += allocation[processId][j]; allocation[processId][j] = 0; need[processId][j] = 0;
+        }
+        if (wholeRow) setRequestRow(processId, vector<int>());  // A terminated process waits for nothing
+    }
+
+    // Safety check that consults the verdict cache (when enabled) by state fingerprint
+    bool checkSafety(const vector<int>& availableVec, const vector<vector<int>>& allocationMat,
+                     const vector<vector<int>>& needMat, const StateHash& hash, vector<int>& safeSequence,
+                     int grantProcess = -1, const vector<int>* grantVec = nullptr) const {
+        shared_ptr<VerdictCache> cache = atomic_load(&verdictCache);
+        if (!cache) return computeSafeSequence(availableVec, allocationMat, needMat, safeSequence, nullptr, grantProcess, grantVec);
+        StateHash key = grantProcess >= 0 ? hashWithGrant(hash, availableVec, allocationMat, needMat, grantProcess, *grantVec) : hash;
+        bool safe;
+        if (cache->lookup(key, safe, safeSequence)) return safe;
+        safe = computeSafeSequence(availableVec, allocationMat, needMat, safeSequence, nullptr, grantProcess, grantVec);
+        cache->store(key, safe, safeSequence);
+        return safe;
+    }
+
+    // Check request bounds against a given state (no safety pass)
+    static AdmissionResult validateRequest(int numProcesses, int numResources, const vector<int>& available,
+                                           const vector<vector<int>>& need, int processId, const vector<int>& requestVec) {
+        if (processId < 0 || processId >= numProcesses) return AdmissionResult::InvalidProcess;
+        if ((int)requestVec.size() != numResources) return AdmissionResult::LengthMismatch;
+        for (int j = 0; j < numResources; ++j) {
+            if (requestVec[j] < 0 || requestVec[j] > need[processId][j]) return AdmissionResult::ExceedsNeed;
+        }
+        for (int j = 0; j < numResources; ++j) {
+            if (requestVec[j] > available[j]) return AdmissionResult::NotAvailable;
+        }
+        return AdmissionResult::Granted;
+    }
+
+    // Optimistic admission behind admitRequest (see there)
+    AdmissionResult admitOptimistically(int processId, const vector<int>& requestVec) {
+        vector<int> safeSeq;
+        bool haveSequence = false;
+        for (int attempt = 0; attempt < kOptimisticAttempts; ++attempt) {
+            shared_ptr<const StateSnapshot> snap = snapshot();
+            AdmissionResult verdict = validateRequest(snap->numProcesses, snap->numResources, snap->available,
+                                                      snap->need, processId, requestVec);
+            if (verdict != AdmissionResult::Granted) return verdict;
+            // After a concurrent grant, replay the sequence found earlier on the newer snapshot
+            // in O(nm); search again only if it no longer holds. Both run outside the lock.
+            if (!haveSequence || !verifySafeSequence(snap->available, snap->allocation, snap->need, safeSeq,
+                                                     processId, &requestVec)) {
+                if (!checkSafety(snap->available, snap->allocation, snap->need, snap->hash, safeSeq,
+                                 processId, &requestVec)) {
+                    return AdmissionResult::Unsafe;
+                }
+                haveSequence = true;
+            }
+
+            lock_guard<recursive_mutex> lock(stateMutex);
+            if (grantEpoch.load() != snap->grantEpoch) continue;  // A grant landed since the snapshot
+            verdict = validateRequest(numProcesses, numResources, available, need, processId, requestVec);
+            if (verdict != AdmissionResult::Granted) return verdict;
+            adjustAllocation(processId, requestVec, +1);
+            setRequestRow(processId, vector<int>());
+            commitLocked(true);
+            return AdmissionResult::Granted;
+        }
+
+        lock_guard<recursive_mutex> lock(stateMutex);
+        AdmissionResult verdict = validateRequest(numProcesses, numResources, available, need, processId, requestVec);
+        if (verdict != AdmissionResult::Granted) return verdict;
+        if (!checkSafety(available, allocation, need, stateHash, safeSeq, processId, &requestVec)) {
+            return AdmissionResult::Unsafe;
+        }
+        adjustAllocation(processId, requestVec, +1);
+        setRequestRow(processId, vector<int>());
+        commitLocked(true);
+        return AdmissionResult::Granted;
+    }
+
+    // A request that must wait (not available / unsafe) becomes the process's outstanding request
+    static bool isBlockingDenial(AdmissionResult result) {
+        return result == AdmissionResult::NotAvailable || result == AdmissionResult::Unsafe;
+    }
+
+    // Batch admission behind admitBatch, all under one lock (see there)
+    void admitBatchLocked(const vector<pair<int, vector<int>>>& requests, vector<AdmissionResult>& results) {
+        results.assign(requests.size(), AdmissionResult::Granted);
+        if (requests.empty()) return;
+        lock_guard<recursive_mutex> lock(stateMutex);
+
+        vector<size_t> applied;
+        for (size_t k = 0; k < requests.size(); ++k) {
+            results[k] = validateRequest(numProcesses, numResources, available, need,
+                                         requests[k].first, requests[k].second);
+            if (results[k] == AdmissionResult::Granted) {
+                applyAllocation(requests[k].first, requests[k].second, +1);  // Journaled once it stands
+                applied.push_back(k);
+            }
+        }
+        if (applied.empty()) {
+            bool changed = false;
+            for (size_t k = 0; k < requests.size(); ++k) {
+                if (isBlockingDenial(results[k])) changed = setRequestRow(requests[k].first, requests[k].second) || changed;
+            }
+            if (changed) commitLocked(false);
+            return;
+        }
+
+        vector<int> safeSeq;
+        if (checkSafety(available, allocation, need, stateHash, safeSeq)) {
+            for (size_t k : applied) journalVector(REC_GRANT, requests[k].first, requests[k].second);
+            for (size_t k = 0; k < requests.size(); ++k) {
+                if (results[k] == AdmissionResult::Granted) setRequestRow(requests[k].first, vector<int>());
+                else if (isBlockingDenial(results[k])) setRequestRow(requests[k].first, requests[k].second);
+            }
+            commitLocked(true);
+            return;
+        }
+
+        for (size_t a = applied.size(); a-- > 0;) {
+            applyAllocation(requests[applied[a]].first, requests[applied[a]].second, -1);
+        }
+        bool anyGranted = false;
+        for (size_t k = 0; k < requests.size(); ++k) {
+            const vector<int>& req = requests[k].second;
+            int pid = requests[k].first;
+            results[k] = validateRequest(numProcesses, numResources, available, need, pid, req);
+            if (results[k] != AdmissionResult::Granted) continue;
+            if (!checkSafety(available, allocation, need, stateHash, safeSeq, pid, &req)) {
+                results[k] = AdmissionResult::Unsafe;
+                continue;
+            }
+            adjustAllocation(pid, req, +1);
+            anyGranted = true;
+        }
+        bool changed = anyGranted;
+        for (size_t k = 0; k < requests.size(); ++k) {
+            if (results[k] == AdmissionResult::Granted) setRequestRow(requests[k].first, vector<int>());
+            else if (isBlockingDenial(results[k])) changed = setRequestRow(requests[k].first, requests[k].second) || changed;
+        }
+        if (changed) commitLocked(anyGranted);
+    }
+
+    // Record that a process is blocked on requestVec (empty vector: no longer blocked).
+    // Outstanding requests do not affect safety, so this never bumps the grant epoch. Returns
+    // false, journaling nothing, when the row already holds that request.
+    bool setRequestRow(int processId, const vector<int>& requestVec) {
+        vector<int>& row = request[processId];
+        bool unchanged = requestVec.empty() ? all_of(row.begin(), row.end(), [](int v) { return v == 0; })
+                                            : row == requestVec;
+        if (unchanged) return false;
+        journalVector(REC_REQUEST_ROW, processId, requestVec);
+        touchRow(processId);
+        if (requestVec.empty()) row.assign(numResources, 0);
+        else row = requestVec;
+        return true;
+    }
+
+    // Set a process's maximum claim (need follows it); processId == numProcesses appends a
+    // new process with nothing allocated or requested. exiting marks the slot as free.
+    void setMaximumRow(int processId, const vector<int>& maximumRow, bool exiting = false) {
+        journalVector(REC_MAXIMUM_ROW, processId, maximumRow, exiting ? REC_EXIT : 0);
+        if (processId == numProcesses) {
+            toggleCell(stateHash, CELL_SHAPE, numProcesses, numResources, 0);
+            toggleCell(stateHash, CELL_SHAPE, numProcesses + 1, numResources, 0);
+            maximum.push_back(vector<int>(numResources, 0));
+            allocation.push_back(vector<int>(numResources, 0));
+            need.push_back(vector<int>(numResources, 0));
+            request.push_back(vector<int>(numResources, 0));
+            for (int j = 0; j < numResources; ++j) {
+                toggleCell(stateHash, CELL_ALLOCATION, processId, j, 0);
+                toggleCell(stateHash, CELL_NEED, processId, j, 0);
+            }
+            exited.push_back(false);
+            numProcesses++;
+        }
+        exited[processId] = exiting;
+        touchRow(processId);
+        for (int j = 0; j < numResources; ++j) {
+            maximum[processId][j] = maximumRow[j];
+            int newNeed = max(0, maximumRow[j] - allocation[processId][j]);
+            changeCell(stateHash, CELL_NEED, processId, j, need[processId][j], newNeed);
+            need[processId][j] = newNeed;
+        }
+    }
+
+    // Holt graph reduction over the outstanding-request matrix. A process is reducible once
+    // its request fits in work; reducing it returns its allocation to work. Waiters on each
+    // resource are kept sorted by amount so every waiter is visited once per resource: O(nm)
+    // with the counting sort (O(nm log n) only when amounts are too sparse for it), instead of
+    // the O(n^2 m) repeated sweeps of the safety check.
+    struct RequestWaiter { int resource, amount, process; };
+
+    static bool reduceRequestGraph(const StateSnapshot& s, vector<int>& deadlocked, const vector<bool>* focus = nullptr) {
+        deadlocked.clear();
+        int n = s.numProcesses, m = s.numResources;
+        vector<int> work = s.available;
+        vector<int> remaining(n, 0);      // Resources whose request still exceeds work
+        vector<RequestWaiter> waiters;    // Sorted by (resource, amount)
+        vector<int> worklist;
+        vector<bool> reduced(n, false);
+        int maxAmount = 0;
+
+        for (int i = 0; i < n; ++i) {
+            const vector<int>& req = s.request[i];
+            for (int j = 0; j < m; ++j) {
+                if (req[j] > work[j]) {
+                    remaining[i]++;
+                    maxAmount = max(maxAmount, req[j]);
+                    RequestWaiter w = { j, req[j], i };
+                    waiters.push_back(w);
+                }
+            }
+            if (remaining[i] == 0) worklist.push_back(i);
+        }
+
+        // Request amounts are usually small, so a counting sort over (resource, amount) keeps
+        // the whole reduction linear; fall back to a comparison sort for sparse large amounts
+        size_t keys = (size_t)m * ((size_t)maxAmount + 1);
+        if (keys <= 4 * waiters.size() + 4096) {
+            vector<size_t> start(keys + 1, 0);
+            auto keyOf = [&](const RequestWaiter& w) { return (size_t)w.resource * (maxAmount + 1) + (size_t)w.amount; };
+            for (const RequestWaiter& w : waiters) start[keyOf(w) + 1]++;
+            for (size_t k = 0; k < keys; ++k) start[k + 1] += start[k];
+            vector<RequestWaiter> ordered(waiters.size());
+            for (const RequestWaiter& w : waiters) ordered[start[keyOf(w)]++] = w;
+            waiters.swap(ordered);
+        } else {
+            sort(waiters.begin(), waiters.end(), [](const RequestWaiter& a, const RequestWaiter& b) {
+                return a.resource != b.resource ? a.resource < b.resource : a.amount < b.amount;
+            });
+        }
+        vector<size_t> cursor(m + 1, waiters.size());  // cursor[j]: next unsatisfied waiter on resource j
+        for (size_t w = waiters.size(); w-- > 0;) cursor[waiters[w].resource] = w;
+        for (int j = m - 1; j >= 0; --j) if (cursor[j] > cursor[j + 1]) cursor[j] = cursor[j + 1];
+        vector<size_t> end(m);
+        for (int j = 0; j < m; ++j) end[j] = cursor[j + 1];
+
+        int focusLeft = 0;
+        if (focus != nullptr) for (int i = 0; i < n; ++i) if ((*focus)[i]) focusLeft++;
+
+        while (!worklist.empty()) {
+            int i = worklist.back();
+            worklist.pop_back();
+            reduced[i] = true;
+            if (focus != nullptr && (*focus)[i] && --focusLeft == 0) return true;  // Every focus process can proceed
+            for (int j = 0; j < m; ++j) {
+                if (s.allocation[i][j] == 0) continue;
+                work[j] += s.allocation[i][j];
+                while (cursor[j] < end[j] && waiters[cursor[j]].amount <= work[j]) {
+                    int k = waiters[cursor[j]++].process;
+                    if (--remaining[k] == 0) worklist.push_back(k);
+                }
+            }
+        }
+        for (int i = 0; i < n; ++i) if (!reduced[i]) deadlocked.push_back(i);
+        return deadlocked.empty();
+    }
+
+    // Binary search behind maxSafeGrantAlong, on one snapshot
+    static int maxSafeGrantOn(const StateSnapshot& s, int processId, const vector<int>& direction) {
+        if (processId < 0 || processId >= s.numProcesses || (int)direction.size() != s.numResources) return -1;
+        int hi = INT_MAX;
+        for (int j = 0; j < s.numResources; ++j) {
+            if (direction[j] < 0) return -1;
+            if (direction[j] > 0) hi = min(hi, min(s.need[processId][j], s.available[j]) / direction[j]);
+        }
+        if (hi == INT_MAX || hi <= 0) return 0;
+
+        vector<int> grant(s.numResources), safeSeq;
+        auto safeWith = [&](int k) {
+            for (int j = 0; j < s.numResources; ++j) grant[j] = k * direction[j];
+            return computeSafeSequence(s.available, s.allocation, s.need, safeSeq, nullptr, processId, &grant);
+        };
+        if (!safeWith(0)) return 0;     // Unsafe already: no grant can help
+        if (safeWith(hi)) return hi;    // Common case: the whole bound is safe
+        int lo = 0;                     // Invariant: lo safe, hi unsafe
+        while (hi - lo > 1) {
+            int mid = lo + (hi - lo) / 2;
+            if (safeWith(mid)) lo = mid; else hi = mid;
+        }
+        return lo;
+    }
+
+    // Copy the current state; the caller holds stateMutex
+    shared_ptr<const StateSnapshot> buildSnapshotLocked() const {
+        shared_ptr<StateSnapshot> fresh = make_shared<StateSnapshot>();
+        fillSnapshotLocked(*fresh, 0);
+        return fresh;
+    }
+
+    // Apply one recovered journal record to the live state (journal detached, lock held).
+    // Returns false for a record that does not fit the current state.
+    bool applyJournalRecord(const JournalRecordHeader& header, const vector<int32_t>& values) {
+        if (header.type == REC_LOAD) {
+            if (values.size() < 2 || values[0] <= 0 || values[1] <= 0) return false;
+            int p = values[0], r = values[1];
+            size_t cells = 2 + (size_t)r + 4 * (size_t)p * r;
+            if (values.size() != cells && values.size() != cells + p) return false;
+            const int32_t* v = values.data() + 2;
+            numProcesses = p;
+            numResources = r;
+            available.assign(v, v + r);
+            v += r;
+            vector<vector<int>>* matrices[] = { &maximum, &allocation, &need, &request };
+            for (vector<vector<int>>* mat : matrices) {
+                mat->assign(p, vector<int>());
+                for (int i = 0; i < p; ++i, v += r) (*mat)[i].assign(v, v + r);
+            }
+            exited.assign(p, false);
+            if (values.size() > cells) for (int i = 0; i < p; ++i) exited[i] = v[i] != 0;
+            stateHash = hashState(available, allocation, need);
+            touchAll();
+            return true;
+        }
+        int limit = header.type == REC_MAXIMUM_ROW ? numProcesses + 1 : numProcesses;  // Arrivals append
+        if (header.processId < 0 || header.processId >= limit) return false;
+        vector<int> vec;
+        if (!unpackJournalVector(header, values, vec)) return false;
+        switch (header.type) {
+            case REC_GRANT:
+            case REC_RELEASE:
+                if ((int)vec.size() != numResources) return false;
+                applyAllocation(header.processId, vec, header.type == REC_GRANT ? +1 : -1);
+                return true;
+            case REC_RECLAIM:
+                reclaimFromProcess(header.processId, (header.flags & REC_WHOLE_ROW) != 0);
+                return true;
+            case REC_REQUEST_ROW:
+                if (!vec.empty() && (int)vec.size() != numResources) return false;
+                setRequestRow(header.processId, vec);
+                return true;
+            case REC_MAXIMUM_ROW:
+                if ((int)vec.size() != numResources) return false;
+                setMaximumRow(header.processId, vec, (header.flags & REC_EXIT) != 0);
+                return true;
+        }
+        return false;
+    }
+
+    // Load the latest snapshot in directory, then replay the journal tail after it. Segments
+    // are read in order; a torn or corrupt record ends its segment (the next segment continues
+    // from the last good LSN), and a gap in LSNs ends recovery. The caller holds the lock.
+    void recoverLocked(const string& directory, uint64_t& lastLsn, uint64_t& firstSegment,
+                       uint64_t& nextSegment, size_t& replayed) {
+        lastLsn = 0; firstSegment = 1; replayed = 0;
+        JournalRecordHeader header;
+        vector<int32_t> values;
+        FILE* file = fopen(journalSnapshotPath(directory).c_str(), "rb");
+        if (file) {
+            if (readJournalRecord(file, header, values) && header.type == REC_LOAD &&
+                header.processId > 0 && applyJournalRecord(header, values)) {
+                lastLsn = header.lsn;
+                firstSegment = (uint64_t)header.processId;
+            }
+            fclose(file);
+        }
+        // Segments below the snapshot's tail may survive a crash between snapshot and cleanup
+        for (uint64_t stale = firstSegment; stale-- > 1;) {
+            if (remove(journalSegmentPath(directory, stale).c_str()) != 0) break;
+        }
+
+        bool gap = false;
+        nextSegment = firstSegment;
+        for (;; ++nextSegment) {
+            file = fopen(journalSegmentPath(directory, nextSegment).c_str(), "rb");
+            if (!file) break;
+            while (!gap && readJournalRecord(file, header, values)) {
+                if (header.lsn <= lastLsn) continue;             // Already in the snapshot
+                if (header.lsn != lastLsn + 1 || !applyJournalRecord(header, values)) { gap = true; break; }
+                lastLsn = header.lsn;
+                replayed++;
+            }
+            fclose(file);
+        }
+        if (numProcesses > 0) commitLocked(true);
+    }
+
+    // Background thread: snapshot once enough records have accumulated since the last one
+    void checkpointLoop() {
+        unique_lock<mutex> lock(checkpointMutex);
+        while (!checkpointStop) {
+            checkpointWake.wait_for(lock, chrono::milliseconds(100));
+            if (checkpointStop) break;
+            shared_ptr<StateJournal> j = atomic_load(&journal);
+            if (!j || j->appendedLsn() - checkpointedLsn.load() < checkpointEvery) continue;
+            lock.unlock();
+            checkpoint();
+            lock.lock();
+        }
+    }
+
+    // Calculate need matrix: Need = Maximum - Allocation
+    void calculateNeed() {
+        need.assign(numProcesses, vector<int>(numResources, 0));
+        for (int i = 0; i < numProcesses; ++i) {
+            for (int j = 0; j < numResources; ++j) {
+                need[i][j] = maximum[i][j] - allocation[i][j];
+                if (need[i][j] < 0) need[i][j] = 0; // Safety check
+            }
+        }
+        stateHash = hashState(available, allocation, need);
+    }
+
+public:
+    // Constructor: Initialize system parameters and seed random generator
+    DeadlockDetector() : numProcesses(0), numResources(0), stateHash(), stateVersion(1), grantEpoch(1), reshapedAt(0),
+                         checkpointStop(false), checkpointEvery(0), checkpointedLsn(0) {
+        srand(static_cast<unsigned>(time(nullptr)));  // Seed for random data generation
+        publishLocked();                              // Empty state until something is loaded
+    }
+
+    ~DeadlockDetector() { closeJournal(); }
+
+    // Return the immutable copy of the committed state published by the latest commit.
+    // Never takes the state lock, so long scans and slow consoles never block commits.
+    shared_ptr<const StateSnapshot> snapshot() const { return atomic_load(&publishedSnapshot); }
+
+    // Read system state from the input files in directory
+    bool readFromFiles(const string& directory = ".") {
+        // Open required input files
+        ifstream availFile(directory + "/available.txt");
+        ifstream maxFile(directory + "/maximum.txt");
+        ifstream allocFile(directory + "/allocation.txt");
+
+        // Check if all files opened successfully
+        if (!availFile || !maxFile || !allocFile) {
+            cout << "Error: Could not open one or more input files!\n";
+            cout << "Required files: available.txt, maximum.txt, allocation.txt\n";
+            return false;
+        }
+
+        // Parse into locals and commit only when every file agrees, so a bad file never
+        // leaves the detector with matrices of different shapes
+        int fileNumResources = 0;
+        if (!(availFile >> fileNumResources) || fileNumResources <= 0) {
+            cout << "Error reading available.txt header.\n";
+            return false;
+        }
+        vector<int> fileAvailable(fileNumResources, 0);
+        for (int i = 0; i < fileNumResources; ++i) {
+            if (!(availFile >> fileAvailable[i])) {
+                cout << "Error: available.txt does not contain enough resource values.\n";
+                return false;
+            }
+        }
+
+        int fileNumProcesses = 0, fileNumResources2 = 0;
+        if (!(maxFile >> fileNumProcesses >> fileNumResources2) || fileNumProcesses <= 0 || fileNumResources2 <= 0) {
+            cout << "Error reading maximum.txt header. Expect: <numProcesses> <numResources>\n";
+            return false;
+        }
+        if (fileNumResources2 != fileNumResources) {
+            cout << "Error: numResources in maximum.txt (" << fileNumResources2
+                 << ") differs from available.txt (" << fileNumResources << ").\n";
+            return false;
+        }
+        vector<vector<int>> fileMaximum(fileNumProcesses, vector<int>(fileNumResources, 0));
+        for (int i = 0; i < fileNumProcesses; ++i) {
+            for (int j = 0; j < fileNumResources; ++j) {
+                if (!(maxFile >> fileMaximum[i][j])) {
+                    cout << "Error: maximum.txt does not contain enough matrix values.\n";
+                    return false;
+                }
+            }
+        }
+
+        int allocP = 0, allocR = 0;
+        if (!(allocFile >> allocP >> allocR)) {
+            cout << "Error reading allocation.txt header. Expect: <numProcesses> <numResources>\n";
+            return false;
+        }
+        if (allocP != fileNumProcesses || allocR != fileNumResources) {
+            cout << "Error: allocation.txt dimensions (" << allocP << "x" << allocR
+                 << ") differ from maximum.txt (" << fileNumProcesses << "x" << fileNumResources << ").\n";
+            return false;
+        }
+        vector<vector<int>> fileAllocation(fileNumProcesses, vector<int>(fileNumResources, 0));
+        for (int i = 0; i < fileNumProcesses; ++i) {
+            for (int j = 0; j < fileNumResources; ++j) {
+                if (!(allocFile >> fileAllocation[i][j])) {
+                    cout << "Error: allocation.txt does not contain enough matrix values.\n";
+                    return false;
+                }
+            }
+        }
+
+        // Outstanding requests are optional: request.txt uses the allocation.txt layout
+        vector<vector<int>> fileRequest(fileNumProcesses, vector<int>(fileNumResources, 0));
+        ifstream reqFile(directory + "/request.txt");
+        int reqP = 0, reqR = 0;
+        if (reqFile && reqFile >> reqP >> reqR) {
+            if (reqP != fileNumProcesses || reqR != fileNumResources) {
+                cout << "Warning: request.txt dimensions (" << reqP << "x" << reqR << ") do not match; ignoring it.\n";
+            } else {
+                for (int i = 0; i < fileNumProcesses; ++i) {
+                    for (int j = 0; j < fileNumResources; ++j) {
+                        if (!(reqFile >> fileRequest[i][j]) || fileRequest[i][j] < 0) {
+                            cout << "Warning: request.txt is incomplete; ignoring it.\n";
+                            fileRequest.assign(fileNumProcesses, vector<int>(fileNumResources, 0));
+                            i = fileNumProcesses;
+                            break;
+                        }
+                    }
+                }
+            }
+        }
+
+        availFile.close();
+        maxFile.close();
+        allocFile.close();
+        if (loadState(fileAvailable, fileMaximum, fileAllocation, &fileRequest)) return true;
+        cout << "Error: the loaded state could not be made durable.\n";
+        return false;
+    }
+
+    // Get system state through user input
+    bool inputFromUser() {
+        cout << "\n========== USER INPUT MODE ==========\n";
+        // Prompt into locals without the lock; loadState then commits everything at once
+        int processes = 0, resources = 0;
+        cout << "Enter number of processes: ";
+        if (!(cin >> processes)) { cin.clear(); cin.ignore(INT_MAX,'\n'); return false; }
+
+        cout << "Enter number of resources: ";
+        if (!(cin >> resources)) { cin.clear(); cin.ignore(INT_MAX,'\n'); return false; }
+
+        if (processes <= 0 || resources <= 0) {
+            cout << "Invalid input! Values must be positive.\n";
+            return false;
+        }
+
+        vector<int> totalResources(resources);
+        cout << "\nEnter total instances of each resource:\n";
+        for (int i = 0; i < resources; i++) {
+            cout << "Resource R" << i << ": ";
+            cin >> totalResources[i];
+            if (totalResources[i] < 0) totalResources[i] = 0;
+        }
+
+        vector<vector<int>> maximumMat(processes, vector<int>(resources, 0));
+        cout << "\nEnter Maximum Matrix (max need for each process):\n";
+        for (int i = 0; i < processes; i++) {
+            cout << "Process P" << i << " (enter " << resources << " values): ";
+            for (int j = 0; j < resources; j++) {
+                cin >> maximumMat[i][j];
+                if (maximumMat[i][j] < 0) maximumMat[i][j] = 0;
+            }
+        }
+
+        vector<vector<int>> allocationMat(processes, vector<int>(resources, 0));
+        cout << "\nEnter Allocation Matrix (currently allocated resources):\n";
+        for (int i = 0; i < processes; i++) {
+            cout << "Process P" << i << " (enter " << resources << " values): ";
+            for (int j = 0; j < resources; j++) {
+                cin >> allocationMat[i][j];
+                if (allocationMat[i][j] < 0) allocationMat[i][j] = 0;
+                if (allocationMat[i][j] > maximumMat[i][j]) {
+                    cout << "Error: Allocation cannot exceed maximum for P" << i << " R" << j << "!\n";
+                    return false;
+                }
+            }
+        }
+
+        vector<int> availableVec(resources, 0);
+        for (int j = 0; j < resources; j++) {
+            int totalAllocated = 0;
+            for (int i = 0; i < processes; i++) totalAllocated += allocationMat[i][j];
+            availableVec[j] = totalResources[j] - totalAllocated;
+            if (availableVec[j] < 0) {
+                cout << "Error: Allocation exceeds total resources for R" << j << "!\n";
+                return false;
+            }
+        }
+
+        if (!loadState(availableVec, maximumMat, allocationMat)) return false;
+        cout << "\n[SUCCESS] Data entered successfully!\n";
+        return true;
+    }
+
+    // Generate random system state for testing
+    bool generateRandomInput() {
+        cout << "\n========== RANDOM INPUT GENERATION ==========\n";
+
+        cout << "Enter number of processes (or 0 for random 3-7): ";
+        int p; cin >> p;
+        if (p == 0) p = 3 + rand() % 5;
+
+        cout << "Enter number of resources (or 0 for random 3-5): ";
+        int r; cin >> r;
+        if (r == 0) r = 3 + rand() % 3;
+
+        if (p <= 0 || r <= 0) {
+            cout << "Invalid input!\n";
+            return false;
+        }
+
+        cout << "\nGenerating random data...\n";
+        cout << "Processes: " << p << "\n";
+        cout << "Resources: " << r << "\n";
+
+        generateRandomState(p, r);
+        cout << "\n[SUCCESS] Random data generated successfully!\n";
+        return true;
+    }
+
+    // Generate a random system state of the given size without prompting
+    bool generateRandomState(int processes, int resources) {
+        mt19937 rng(static_cast<unsigned>(rand()));
+        return generateRandomState(processes, resources, rng);
+    }
+
+    // Same, drawing from the caller's generator so a fixed seed reproduces the state
+    bool generateRandomState(int processes, int resources, mt19937& rng) {
+        if (processes <= 0 || resources <= 0) return false;
+        vector<int> totalResources(resources);
+        for (int j = 0; j < resources; j++) totalResources[j] = 5 + (int)(rng() % 11);
+
+        vector<vector<int>> maximumMat(processes, vector<int>(resources, 0));
+        for (int i = 0; i < processes; i++) {
+            for (int j = 0; j < resources; j++) {
+                int half = max(1, totalResources[j] / 2);
+                maximumMat[i][j] = 1 + (int)(rng() % (half + 1));
+            }
+        }
+
+        vector<vector<int>> allocationMat(processes, vector<int>(resources, 0));
+        vector<int> totalAllocated(resources, 0);
+        for (int i = 0; i < processes; i++) {
+            for (int j = 0; j < resources; j++) {
+                int maxAlloc = min(maximumMat[i][j], totalResources[j] - totalAllocated[j]);
+                if (maxAlloc < 0) maxAlloc = 0;
+                allocationMat[i][j] = (maxAlloc == 0) ? 0 : (int)(rng() % (maxAlloc + 1));
+                totalAllocated[j] += allocationMat[i][j];
+            }
+        }
+
+        vector<int> availableVec(resources, 0);
+        for (int j = 0; j < resources; j++) availableVec[j] = totalResources[j] - totalAllocated[j];
+
+        // Roughly half the processes are blocked on part of their remaining need
+        vector<vector<int>> requestMat(processes, vector<int>(resources, 0));
+        for (int i = 0; i < processes; i++) {
+            if (rng() % 2) continue;
+            for (int j = 0; j < resources; j++) {
+                requestMat[i][j] = (int)(rng() % (maximumMat[i][j] - allocationMat[i][j] + 1));
+            }
+        }
+        return loadState(availableVec, maximumMat, allocationMat, &requestMat);
+    }
+
+    // Load an explicit system state (available, maximum, allocation) without prompting. False
+    // for mismatched shapes, or when the journal could not make the new state durable.
+    bool loadState(const vector<int>& availableVec, const vector<vector<int>>& maximumMat,
+                   const vector<vector<int>>& allocationMat, const vector<vector<int>>* requestMat = nullptr) {
+        int p = (int)maximumMat.size(), r = (int)availableVec.size();
+        if (p <= 0 || r <= 0 || (int)allocationMat.size() != p) return false;
+        if (requestMat != nullptr && (int)requestMat->size() != p) return false;
+        for (int i = 0; i < p; ++i) {
+            if ((int)maximumMat[i].size() != r || (int)allocationMat[i].size() != r) return false;
+            if (requestMat != nullptr && (int)(*requestMat)[i].size() != r) return false;
+        }
+        DurableScope durable(*this);
+        {
+            lock_guard<recursive_mutex> lock(stateMutex);
+            numProcesses = p;
+            numResources = r;
+            available = availableVec;
+            maximum = maximumMat;
+            allocation = allocationMat;
+            if (requestMat != nullptr) request = *requestMat;
+            else request.assign(numProcesses, vector<int>(numResources, 0));
+            calculateNeed();
+            commitReloadLocked();
+        }
+        return durable.wait();
+    }
+
+    // Display current system state (all matrices)
+    void displayState() {
+        // Print from a snapshot so a slow terminal never holds up admissions
+        shared_ptr<const StateSnapshot> snap = snapshot();
+        const StateSnapshot& s = *snap;
+        cout << "\n========== CURRENT SYSTEM STATE ==========\n";
+
+        cout << "\nAvailable Resources: ";
+        for (int i = 0; i < s.numResources; i++) {
+            cout << "R" << i << ":" << s.available[i] << " ";
+        }
+        cout << "\n";
+
+        cout << "\nAllocation Matrix:\n     ";
+        for (int j = 0; j < s.numResources; j++) cout << "R" << j << "  ";
+        cout << "\n";
+        for (int i = 0; i < s.numProcesses; i++) {
+            cout << "P" << i << ": ";
+            for (int j = 0; j < s.numResources; j++) cout << setw(3) << s.allocation[i][j] << " ";
+            cout << "\n";
+        }
+
+        cout << "\nMaximum Matrix:\n     ";
+        for (int j = 0; j < s.numResources; j++) cout << "R" << j << "  ";
+        cout << "\n";
+        for (int i = 0; i < s.numProcesses; i++) {
+            cout << "P" << i << ": ";
+            for (int j = 0; j < s.numResources; j++) cout << setw(3) << s.maximum[i][j] << " ";
+            cout << "\n";
+        }
+
+        cout << "\nNeed Matrix:\n     ";
+        for (int j = 0; j < s.numResources; j++) cout << "R" << j << "  ";
+        cout << "\n";
+        for (int i = 0; i < s.numProcesses; i++) {
+            cout << "P" << i << ": ";
+            for (int j = 0; j < s.numResources; j++) cout << setw(3) << s.need[i][j] << " ";
+            cout << "\n";
+        }
+
+        cout << "\nRequest Matrix (outstanding):\n     ";
+        for (int j = 0; j < s.numResources; j++) cout << "R" << j << "  ";
+        cout << "\n";
+        for (int i = 0; i < s.numProcesses; i++) {
+            cout << "P" << i << ": ";
+            for (int j = 0; j < s.numResources; j++) cout << setw(3) << s.request[i][j] << " ";
+            cout << "\n";
+        }
+        cout << "==========================================\n";
+    }
+
+    // Banker's Algorithm: Check for safe state and find safe sequence. Scans and prints a
+    // snapshot, like waitForGraphDetection, so the console never holds the state lock.
+    bool bankersAlgorithmDetection(vector<int>& safeSequence, const vector<bool>* terminatedProcesses = nullptr) {
+        shared_ptr<const StateSnapshot> snap = snapshot();
+        const StateSnapshot& s = *snap;
+        countMetric(CTR_DETECTIONS);
+        if (terminatedProcesses != nullptr && (int)terminatedProcesses->size() != s.numProcesses) terminatedProcesses = nullptr;
+
+        if (!computeSafeSequence(s.available, s.allocation, s.need, safeSequence, terminatedProcesses)) {
+            vector<bool> finish(s.numProcesses, false);
+            for (int i : safeSequence) finish[i] = true;
+            cout << "\n[DEADLOCK DETECTED] System is in unsafe state!\n";
+            cout << "Processes that cannot finish: ";
+            for (int i = 0; i < s.numProcesses; ++i) {
+                if (!finish[i] && (terminatedProcesses == nullptr || !(*terminatedProcesses)[i])) {
+                    cout << "P" << i << " ";
+                }
+            }
+            cout << "\n";
+            countMetric(CTR_DEADLOCKS_FOUND);
+            return false;
+        }
+
+        cout << "\n[SAFE STATE] No deadlock detected.";
+        if (!safeSequence.empty()) {
+            cout << "\nSafe sequence: ";
+            for (int i : safeSequence) cout << "P" << i << " ";
+        } else {
+            cout << "\nAll processes have been terminated.";
+        }
+        cout << "\n";
+        return true;
+    }
+
+    bool bankersAlgorithmCompute(vector<int>& safeSequence, const vector<bool>* terminatedProcesses = nullptr) {
+        lock_guard<recursive_mutex> lock(stateMutex);
+        if (terminatedProcesses == nullptr) return checkSafety(available, allocation, need, stateHash, safeSequence);
+        return computeSafeSequence(available, allocation, need, safeSequence, terminatedProcesses);
+    }
+
+    // Quiet safety check against the latest snapshot; never blocks admissions
+    bool isSnapshotSafe(vector<int>& safeSequence) const {
+        shared_ptr<const StateSnapshot> snap = snapshot();
+        countMetric(CTR_DETECTIONS);
+        bool safe = checkSafety(snap->available, snap->allocation, snap->need, snap->hash, safeSequence);
+        if (!safe) countMetric(CTR_DEADLOCKS_FOUND);
+        return safe;
+    }
+
+    // Wait-For Graph: Detect deadlock using graph cycle detection
+    bool waitForGraphDetection() {
+        cout << "\n========== WAIT-FOR GRAPH DETECTION ==========" << "\n";
+
+        // Scan a snapshot so admissions can keep committing while the graph is built
+        shared_ptr<const StateSnapshot> snap = snapshot();
+        const StateSnapshot& s = *snap;
+        const int numProcesses = s.numProcesses;
+        const int numResources = s.numResources;
+        countMetric(CTR_DETECTIONS);
+
+        vector<vector<bool>> waitForGraph(numProcesses, vector<bool>(numProcesses, false));
+        vector<bool> blocked(numProcesses, false);
+
+        {
+            ScopedLatency buildTiming(TMR_WFG_BUILD);
+            for (int i = 0; i < numProcesses; ++i) {
+                bool isBlocked = false;
+                for (int j = 0; j < numResources; ++j) {
+                    if (s.need[i][j] > s.available[j]) { isBlocked = true; break; }
+                }
+                blocked[i] = isBlocked;
+                if (!isBlocked) continue;
+
+                for (int j = 0; j < numResources; ++j) {
+                    if (s.need[i][j] > s.available[j]) {
+                        for (int k = 0; k < numProcesses; ++k) {
+                            if (k != i && s.allocation[k][j] > 0) {
+                                waitForGraph[i][k] = true;
+                            }
+                        }
+                    }
+                }
+            }
+        }
+
+        cout << "\nProcesses currently blocked (need > available): ";
+        bool anyBlocked = false;
+        for (int i = 0; i < numProcesses; ++i) if (blocked[i]) { cout << "P" << i << " "; anyBlocked = true; }
+        if (!anyBlocked) cout << "None";
+        cout << "\n";
+
+        cout << "\nWait-For Graph (Pi waits for Pj):\n";
+        for (int i = 0; i < numProcesses; ++i) {
+            cout << "P" << i << " -> ";
+            bool anyEdge = false;
+            for (int j = 0; j < numProcesses; ++j) {
+                if (waitForGraph[i][j]) { cout << "P" << j << " "; anyEdge = true; }
+            }
+            if (!anyEdge) cout << "None";
+            cout << "\n";
+        }
+
+        vector<bool> visited(numProcesses, false), recStack(numProcesses, false);
+        function<bool(int)> hasCycle = [&](int v) -> bool {
+            visited[v] = true;
+            recStack[v] = true;
+            for (int u = 0; u < numProcesses; ++u) {
+                if (waitForGraph[v][u]) {
+                    if (!visited[u] && hasCycle(u)) return true;
+                    else if (recStack[u]) return true;
+                }
+            }
+            recStack[v] = false;
+            return false;
+        };
+
+        bool cycleFound = false;
+        {
+            ScopedLatency searchTiming(TMR_CYCLE_SEARCH);
+            for (int i = 0; i < numProcesses && !cycleFound; ++i) {
+                if (!visited[i] && hasCycle(i)) cycleFound = true;
+            }
+        }
+        if (cycleFound) {
+            cout << "\nDeadlock exists.\n";
+            countMetric(CTR_DEADLOCKS_FOUND);
+            return false;
+        }
+
+        vector<int> safeSeq;
+        if (computeSafeSequence(s.available, s.allocation, s.need, safeSeq)) {
+            cout << "\nSafe sequence: ";
+            for (int p : safeSeq) cout << "P" << p << " ";
+            cout << "\n";
+            return true;
+        } else {
+            cout << "\nDeadlock exists (unsafe state without WFG cycle).\n";
+            countMetric(CTR_DEADLOCKS_FOUND);
+            return false;
+        }
+    }
+
+    // Request-matrix detection: reduce the graph of outstanding requests (not maximum claims),
+    // so only processes that are actually blocked in a cycle are reported
+    bool requestMatrixDetection() {
+        cout << "\n========== REQUEST MATRIX DETECTION (GRAPH REDUCTION) ==========" << "\n";
+        shared_ptr<const StateSnapshot> snap = snapshot();
+        vector<int> deadlocked;
+        bool clear = detectDeadlockByReduction(*snap, deadlocked);
+
+        cout << "\nProcesses with outstanding requests: ";
+        bool anyWaiting = false;
+        for (int i = 0; i < snap->numProcesses; ++i) {
+            bool waiting = false;
+            for (int j = 0; j < snap->numResources; ++j) if (snap->request[i][j] > 0) waiting = true;
+            if (waiting) { cout << "P" << i << " "; anyWaiting = true; }
+        }
+        if (!anyWaiting) cout << "None";
+        cout << "\n";
+
+        if (clear) {
+            cout << "\n[NO DEADLOCK] Every process's outstanding request can eventually be satisfied.\n";
+            return true;
+        }
+        cout << "\n[DEADLOCK DETECTED] Deadlocked processes: ";
+        for (int p : deadlocked) cout << "P" << p << " ";
+        cout << "\n";
+        return false;
+    }
+
+    // Quiet request-matrix detection on the latest snapshot. With a focus set, stops as soon
+    // as every focus process is shown to be able to proceed (deadlocked is then empty).
+    bool detectDeadlockByReduction(vector<int>& deadlocked, const vector<bool>* focus = nullptr) const {
+        shared_ptr<const StateSnapshot> snap = snapshot();
+        return detectDeadlockByReduction(*snap, deadlocked, focus);
+    }
+
+    // Same, on a snapshot the caller already holds
+    bool detectDeadlockByReduction(const StateSnapshot& snap, vector<int>& deadlocked,
+                                   const vector<bool>* focus = nullptr) const {
+        countMetric(CTR_DETECTIONS);
+        bool clear;
+        {
+            ScopedLatency timing(TMR_REDUCTION);
+            if (focus != nullptr && (int)focus->size() != snap.numProcesses) focus = nullptr;  // Stale focus: full scan
+            clear = reduceRequestGraph(snap, deadlocked, focus);
+        }
+        if (!clear) countMetric(CTR_DEADLOCKS_FOUND);
+        return clear;
+    }
+
+    // Replace a process's outstanding request (empty vector clears it); thread-safe. False
+    // also when the journal could not make the change durable.
+    bool setOutstandingRequest(int processId, const vector<int>& requestVec) {
+        DurableScope durable(*this);
+        {
+            lock_guard<recursive_mutex> lock(stateMutex);
+            if (processId < 0 || processId >= numProcesses) return false;
+            if (!requestVec.empty() && (int)requestVec.size() != numResources) return false;
+            for (int r : requestVec) if (r < 0) return false;
+            if (setRequestRow(processId, requestVec)) commitLocked(false);
+        }
+        return durable.wait();
+    }
+
+    // A new process arrives with the given maximum claim. It takes the slot of a process that
+    // left through removeProcess when there is one, so ids stay dense. Returns its id, or -1 for a bad claim or
+    // when the journal could not make the arrival durable.
+    int addProcess(const vector<int>& maximumRow) {
+        DurableScope durable(*this);
+        int slot;
+        {
+            lock_guard<recursive_mutex> lock(stateMutex);
+            if (numResources <= 0 || (int)maximumRow.size() != numResources) return -1;
+            for (int v : maximumRow) if (v < 0) return -1;
+            slot = (int)(find(exited.begin(), exited.end(), true) - exited.begin());  // numProcesses if none
+            setMaximumRow(slot, maximumRow);
+            commitLocked(true);  // A new claim can make a safe state unsafe
+        }
+        return durable.wait() ? slot : -1;
+    }
+
+    // A process exits: what it holds returns to the pool and its slot is freed for reuse.
+    // False also when the journal could not make the exit durable.
+    bool removeProcess(int processId) {
+        DurableScope durable(*this);
+        {
+            lock_guard<recursive_mutex> lock(stateMutex);
+            if (processId < 0 || processId >= numProcesses) return false;
+            reclaimFromProcess(processId, true);
+            setMaximumRow(processId, vector<int>(numResources, 0), true);
+            commitLocked(false);
+        }
+        return durable.wait();
+    }
+
+    // Recovery strategy: Terminate processes to break deadlock
+    void processTermination(bool deadlockPreviouslyDetected) {
+        DurableScope durable(*this);
+        terminateVictims(deadlockPreviouslyDetected);
+        if (!durable.wait()) cout << "[WARNING] The journal could not make the terminations durable.\n";
+    }
+
+    // Recovery strategy: Preempt resources from victim process
+    void resourcePreemption(bool deadlockPreviouslyDetected) {
+        DurableScope durable(*this);
+        preemptVictim(deadlockPreviouslyDetected);
+        if (!durable.wait()) cout << "[WARNING] The journal could not make the preemption durable.\n";
+    }
+
+    // Termination under the state lock (the caller's DurableScope waits once it is released)
+    void terminateVictims(bool deadlockPreviouslyDetected) {
+        cout << "\n========== PROCESS TERMINATION RECOVERY ==========" << "\n";
+        lock_guard<recursive_mutex> lock(stateMutex);
+        if (!deadlockPreviouslyDetected) { cout << "No recovery needed (system safe).\n"; return; }
+        vector<bool> terminated(numProcesses, false);
+        int culprit = -1; int minAlloc = INT_MAX;
+        for (int i = 0; i < numProcesses; ++i) {
+            int totalAlloc = 0; for (int j = 0; j < numResources; ++j) totalAlloc += allocation[i][j];
+            if (totalAlloc < minAlloc && totalAlloc > 0) { minAlloc = totalAlloc; culprit = i; }
+        }
+        if (culprit == -1) { cout << "No suitable culprit to terminate.\n"; return; }
+        cout << "Terminating culprit process P" << culprit << "\n";
+        reclaimFromProcess(culprit, true);
+        commitLocked(false);
+        countMetric(CTR_VICTIMS_TERMINATED);
+        terminated[culprit] = true;
+        vector<int> safeSeq;
+        if (bankersAlgorithmCompute(safeSeq, &terminated)) {
+            cout << "Recovered. New safe sequence: "; for (int p : safeSeq) cout << "P" << p << " "; cout << "\n";
+        } else {
+            cout << "Initial termination insufficient; escalating...\n";
+            int terminationCount = 1;
+            while (true) {
+                int minProcess = -1; int minAllocation2 = INT_MAX;
+                for (int i = 0; i < numProcesses; ++i) if (!terminated[i]) {
+                    int totalAlloc = 0; for (int j = 0; j < numResources; ++j) totalAlloc += allocation[i][j];
+                    if (totalAlloc < minAllocation2) { minAllocation2 = totalAlloc; minProcess = i; }
+                }
+                if (minProcess == -1) break;
+                cout << "Terminating additional process P" << minProcess << "\n";
+                reclaimFromProcess(minProcess, true);
+                commitLocked(false);
+                countMetric(CTR_VICTIMS_TERMINATED);
+                terminated[minProcess] = true; terminationCount++;
+                if (bankersAlgorithmCompute(safeSeq, &terminated)) {
+                    cout << "Recovered after terminating " << terminationCount << " processes. Safe sequence: ";
+                    for (int p : safeSeq) cout << "P" << p << " "; cout << "\n"; return;
+                }
+            }
+            cout << "Recovery failed: still unsafe after terminations.\n";
+        }
+    }
+
+    // Preemption under the state lock (the caller's DurableScope waits once it is released)
+    void preemptVictim(bool deadlockPreviouslyDetected) {
+        cout << "\n========== RESOURCE PREEMPTION RECOVERY ==========" << "\n";
+        lock_guard<recursive_mutex> lock(stateMutex);
+        if (!deadlockPreviouslyDetected) { cout << "No recovery needed (system safe).\n"; return; }
+        cout << "Attempting resource preemption...\n";
+        int victim = -1; int minAlloc = INT_MAX;
+        for (int i = 0; i < numProcesses; ++i) {
+            int totalAlloc = 0; for (int j = 0; j < numResources; ++j) totalAlloc += allocation[i][j];
+            if (totalAlloc > 0 && totalAlloc < minAlloc) { minAlloc = totalAlloc; victim = i; }
+        }
+        if (victim == -1) { cout << "No suitable victim found.\n"; return; }
+        cout << "Preempting resources from P" << victim << " -> ";
+        vector<bool> preempted(numProcesses, false);
+        for (int j = 0; j < numResources; ++j) if (allocation[victim][j] > 0) {
+            cout << "R" << j << ":" << allocation[victim][j] << " ";
+            countMetric(CTR_UNITS_PREEMPTED, allocation[victim][j]);
+            preempted[victim] = true;
+        }
+        reclaimFromProcess(victim, false);
+        commitLocked(false);
+        cout << "\n";
+        vector<int> safeSeq;
+        if (bankersAlgorithmCompute(safeSeq, &preempted)) {
+            cout << "Recovered. Safe sequence: "; for (int p : safeSeq) cout << "P" << p << " "; cout << "\n";
+        } else {
+            cout << "Still unsafe after preemption. Consider termination strategy.\n";
+        }
+    }
+
+    // Interactive admission: decided under the lock, reported after it is released
+    bool requestResources(int processId, vector<int>& requestVec) {
+        AdmissionResult verdict;
+        vector<int> safeSeq;
+        DurableScope durable(*this);
+        {
+            lock_guard<recursive_mutex> lock(stateMutex);
+            ScopedLatency timing(TMR_REQUEST);
+            // Same bounds as the quiet path, so a negative entry can never shrink an allocation
+            verdict = validateRequest(numProcesses, numResources, available, need, processId, requestVec);
+            if (verdict == AdmissionResult::Granted) {
+                // Check with the grant overlaid; live state changes only once it is granted
+                if (checkSafety(available, allocation, need, stateHash, safeSeq, processId, &requestVec)) {
+                    adjustAllocation(processId, requestVec, +1);
+                    setRequestRow(processId, vector<int>());
+                    commitLocked(true);
+                } else {
+                    verdict = AdmissionResult::Unsafe;
+                }
+            }
+            if (isBlockingDenial(verdict) && setRequestRow(processId, requestVec)) {
+                commitLocked(false);  // Process now waits on this request
+            }
+        }
+        if (!durable.wait()) verdict = AdmissionResult::NotDurable;
+        countMetric(static_cast<MetricCounter>(verdict));
+
+        cout << "\n========== BANKER'S ALGORITHM: RESOURCE REQUEST ==========\n";
+        if (verdict == AdmissionResult::InvalidProcess) { cout << "Invalid process ID!\n"; return false; }
+        if (verdict == AdmissionResult::LengthMismatch) { cout << "Request vector length mismatch!\n"; return false; }
+
+        cout << "Process P" << processId << " requesting: ";
+        for (int r : requestVec) cout << r << " ";
+        cout << "\n";
+
+        switch (verdict) {
+            case AdmissionResult::ExceedsNeed:
+                cout << "[REQUEST DENIED] Request exceeds maximum need!\n"; return false;
+            case AdmissionResult::NotAvailable:
+                cout << "[REQUEST DENIED] Resources not currently available!\n"; return false;
+            case AdmissionResult::Unsafe:
+                cout << "[REQUEST DENIED] Allocation would lead to unsafe state.\n"; return false;
+            case AdmissionResult::NotDurable:
+                cout << "[REQUEST FAILED] The journal could not make the change durable.\n"; return false;
+            default:
+                break;
+        }
+        cout << "Safe sequence after the grant: ";
+        for (int p : safeSeq) cout << "P" << p << " ";
+        cout << "\n[REQUEST GRANTED] Resources allocated safely.\n";
+        return true;
+    }
+
+    // Thread-safe admission without console output. The safe-sequence search runs against a
+    // snapshot outside the lock. At commit, if no other grant landed in between the verdict
+    // still holds (releases cannot make a safe state unsafe) and the lock is held only for an
+    // O(m) re-validation; otherwise the found sequence is replayed in O(nm) against the newer
+    // snapshot, still outside the lock, and the search is redone only if that fails. After a
+    // few attempts the request is checked and committed under the lock.
+    AdmissionResult admitRequest(int processId, const vector<int>& requestVec) {
+        ScopedLatency timing(TMR_REQUEST);
+        DurableScope durable(*this);
+        AdmissionResult result = admitOptimistically(processId, requestVec);
+        if (isBlockingDenial(result)) {
+            lock_guard<recursive_mutex> lock(stateMutex);
+            if (processId < numProcesses && (int)requestVec.size() == numResources &&
+                setRequestRow(processId, requestVec)) {
+                commitLocked(false);
+            }
+        }
+        if (!durable.wait()) result = AdmissionResult::NotDurable;
+        countMetric(static_cast<MetricCounter>(result));
+        return result;
+    }
+
+    // Return units held by a process to the available pool (thread-safe, quiet). False also
+    // when the journal could not make the release durable.
+    bool releaseResources(int processId, const vector<int>& releaseVec) {
+        DurableScope durable(*this);
+        {
+            lock_guard<recursive_mutex> lock(stateMutex);
+            if (processId < 0 || processId >= numProcesses) return false;
+            if ((int)releaseVec.size() != numResources) return false;
+            for (int j = 0; j < numResources; ++j) {
+                if (releaseVec[j] < 0 || releaseVec[j] > allocation[processId][j]) return false;
+            }
+            adjustAllocation(processId, releaseVec, -1);
+            commitLocked(false);
+        }
+        return durable.wait();
+    }
+
+    // Admit a batch of requests with one safety pass. Requests are validated and applied in
+    // order; if the combined state is safe, every prefix is safe too (it differs only by
+    // releases), so all valid requests are granted. Otherwise the batch is rolled back and
+    // each request gets its own check.
+    void admitBatch(const vector<pair<int, vector<int>>>& requests, vector<AdmissionResult>& results) {
+        DurableScope durable(*this);
+        admitBatchLocked(requests, results);
+        if (!durable.wait()) {
+            for (AdmissionResult& result : results) {
+                if (result == AdmissionResult::Granted || isBlockingDenial(result)) result = AdmissionResult::NotDurable;
+            }
+        }
+        for (AdmissionResult result : results) countMetric(static_cast<MetricCounter>(result));
+    }
+
+    void simulateResourceRequest() {
+        cout << "\n========== SIMULATE RESOURCE REQUEST ==========\n";
+        shared_ptr<const StateSnapshot> snap = snapshot();  // Shape may change while we prompt
+        int processId;
+        cout << "Enter process ID (0-" << max(0, snap->numProcesses - 1) << "): ";
+        cin >> processId;
+        if (processId < 0 || processId >= snap->numProcesses) { cout << "Invalid process ID!\n"; return; }
+
+        vector<int> requestVec(snap->numResources);
+        cout << "Enter request for " << snap->numResources << " resources: ";
+        for (int i = 0; i < snap->numResources; ++i) cin >> requestVec[i];
+
+        requestResources(processId, requestVec);
+    }
+
+    // Largest k such that granting k * direction to the process keeps the state safe, without
+    // mutating anything. Safety is monotone in k (a smaller grant differs from a larger one only
+    // by a release), so a binary search over a non-mutating safety check finds it.
+    // Returns -1 for invalid arguments.
+    int maxSafeGrantAlong(int processId, const vector<int>& direction) const {
+        return maxSafeGrantOn(*snapshot(), processId, direction);
+    }
+
+    // Largest number of units of one resource the process can be granted right now
+    int maxSafeGrant(int processId, int resource) const {
+        shared_ptr<const StateSnapshot> snap = snapshot();
+        if (resource < 0 || resource >= snap->numResources) return -1;
+        vector<int> direction(snap->numResources, 0);
+        direction[resource] = 1;
+        return maxSafeGrantOn(*snap, processId, direction);
+    }
+
+    // maxSafeGrant for every (process, resource) pair on one snapshot, processes split
+    // across worker threads
+    vector<vector<int>> maxSafeGrantAll(int threads = 0) const {
+        shared_ptr<const StateSnapshot> snap = snapshot();
+        const StateSnapshot& s = *snap;
+        vector<vector<int>> result(s.numProcesses, vector<int>(s.numResources, 0));
+        if (threads <= 0) threads = max(1, (int)thread::hardware_concurrency());
+        threads = max(1, min(threads, s.numProcesses));
+
+        auto worker = [&](int first) {
+            vector<int> direction(s.numResources, 0);
+            for (int i = first; i < s.numProcesses; i += threads) {
+                for (int j = 0; j < s.numResources; ++j) {
+                    direction[j] = 1;
+                    result[i][j] = maxSafeGrantOn(s, i, direction);
+                    direction[j] = 0;
+                }
+            }
+        };
+        vector<thread> pool;
+        for (int t = 1; t < threads; ++t) pool.push_back(thread(worker, t));
+        worker(0);
+        for (thread& t : pool) t.join();
+        return result;
+    }
+
+    // Memoize safety verdicts in an LRU cache of the given size (0 disables it)
+    void enableVerdictCache(size_t capacity) {
+        shared_ptr<VerdictCache> cache;
+        if (capacity > 0) cache = make_shared<VerdictCache>(capacity);
+        atomic_store(&verdictCache, cache);
+    }
+
+    string verdictCacheReport() const {
+        shared_ptr<VerdictCache> cache = atomic_load(&verdictCache);
+        return cache ? cache->report() : string("Verdict cache: disabled\n");
+    }
+
+    // Total instances of each resource (available plus everything allocated)
+    vector<int> totalResources() const {
+        shared_ptr<const StateSnapshot> snap = snapshot();
+        vector<int> total = snap->available;
+        for (const vector<int>& row : snap->allocation) {
+            for (int j = 0; j < snap->numResources; ++j) total[j] += row[j];
+        }
+        return total;
+    }
+
+    // Fingerprint of the committed state
+    StateHash currentStateHash() const { return snapshot()->hash; }
+
+    // Slots freed by removeProcess that the next arrivals will reuse, lowest first
+    vector<int> exitedProcesses() const {
+        lock_guard<recursive_mutex> lock(stateMutex);
+        vector<int> slots;
+        for (int i = 0; i < numProcesses; ++i) if (exited[i]) slots.push_back(i);
+        return slots;
+    }
+
+    // Make the state durable in directory (created if missing). Any state found there (latest
+    // snapshot plus journal tail) replaces the current one; otherwise the current state is
+    // journaled as the starting point. From then on every committed mutation is appended to
+    // the journal, and a background thread writes a snapshot every checkpointRecords records
+    // so restart time stays bounded by snapshot size plus a short tail.
+    bool openJournal(const string& directory, JournalMode mode = JournalMode::Async,
+                     uint64_t checkpointRecords = 100000, int flushIntervalMs = 2) {
+        if (!makeDirectory(directory)) return false;
+        auto start = chrono::steady_clock::now();
+        lock_guard<recursive_mutex> lock(stateMutex);
+        if (journal) return false;
+
+        uint64_t lastLsn, firstSegment, nextSegment;
+        size_t replayed;
+        recoverLocked(directory, lastLsn, firstSegment, nextSegment, replayed);
+        shared_ptr<StateJournal> opened = make_shared<StateJournal>(directory, mode, flushIntervalMs);
+        if (!opened->start(nextSegment, firstSegment, lastLsn)) return false;
+        atomic_store(&journal, opened);
+        if (lastLsn == 0 && numProcesses > 0) commitReloadLocked();
+
+        ostringstream out;
+        out << "Recovered LSN " << lastLsn << " (" << replayed << " records replayed after the snapshot) in "
+            << fixed << setprecision(2) << chrono::duration<double, milli>(chrono::steady_clock::now() - start).count()
+            << " ms\n";
+        recoveryReport = out.str();
+
+        checkpointEvery = max<uint64_t>(1, checkpointRecords);
+        checkpointedLsn = lastLsn - replayed;
+        checkpointStop = false;
+        checkpointThread = thread(&DeadlockDetector::checkpointLoop, this);
+        return true;
+    }
+
+    // Stop background checkpoints and flush the journal
+    void closeJournal() {
+        {
+            lock_guard<mutex> lock(checkpointMutex);
+            checkpointStop = true;
+        }
+        checkpointWake.notify_all();
+        if (checkpointThread.joinable()) checkpointThread.join();
+        shared_ptr<StateJournal> j;
+        {
+            lock_guard<recursive_mutex> lock(stateMutex);
+            j = atomic_load(&journal);
+            atomic_store(&journal, shared_ptr<StateJournal>());
+        }
+        if (j) j->stop();
+    }
+
+    // Write a snapshot of the current state and drop the journal segments it covers. Only the
+    // state copy and a segment switch happen under the lock; the file is written outside it.
+    bool checkpoint() {
+        lock_guard<mutex> serial(checkpointMutex);
+        shared_ptr<StateJournal> j;
+        shared_ptr<const StateSnapshot> snap;
+        vector<bool> exitedSlots;
+        uint64_t tailSegment;
+        {
+            lock_guard<recursive_mutex> lock(stateMutex);
+            j = journal;
+            if (!j || numProcesses <= 0) return false;
+            snap = buildSnapshotLocked();
+            exitedSlots = exited;
+            tailSegment = j->rotate();
+        }
+
+        vector<int32_t> values;
+        packJournalState(snap->numProcesses, snap->numResources, snap->available, snap->maximum,
+                         snap->allocation, snap->need, snap->request, values, &exitedSlots);
+        string bytes;
+        encodeJournalRecord(bytes, snap->journalLsn, REC_LOAD, (int32_t)tailSegment, 0, values);
+
+        string path = journalSnapshotPath(j->directoryPath()), temp = path + ".tmp";
+        FILE* file = fopen(temp.c_str(), "wb");
+        if (!file) return false;
+        bool ok = fwrite(bytes.data(), 1, bytes.size(), file) == bytes.size() && syncFile(file);
+        fclose(file);
+        if (!ok) { remove(temp.c_str()); return false; }
+#ifdef _WIN32
+        remove(path.c_str());  // rename does not replace an existing file on Windows
+#endif
+        if (rename(temp.c_str(), path.c_str()) != 0) return false;
+
+        // Older segments may only go once the flusher has moved past them
+        if (!j->waitFlushed(snap->journalLsn, tailSegment)) return false;
+        j->removeSegmentsBefore(tailSegment);
+        checkpointedLsn = snap->journalLsn;
+        return true;
+    }
+
+    string journalReport() const {
+        lock_guard<recursive_mutex> lock(stateMutex);
+        return journal ? recoveryReport + journal->report() : string("Journal: disabled\n");
+    }
+
+    bool isDataLoaded() const {
+        shared_ptr<const StateSnapshot> snap = snapshot();
+        return snap->numProcesses > 0 && snap->numResources > 0;
+    }
+    int getNumProcesses() const { return snapshot()->numProcesses; }
+    int getNumResources() const { return snapshot()->numResources; }
+};
+
+// Display main menu options
+void displayMainMenu() {
+    cout << "\n========================================================\n";
+    cout << "      DEADLOCK DETECTION & RECOVERY SYSTEM           \n";
+    cout << "========================================================\n";
+    cout << "  1. Load predefined data from files                   \n";
+    cout << "  2. Enter data manually                               \n";
+    cout << "  3. Generate random data                              \n";
+    cout << "  4. Thread Deadlock Detection & Recovery              \n";
+    cout << "  5. Show detector statistics                          \n";
+    cout << "  0. Exit                                              \n";
+    cout << "========================================================\n";
+    cout << "Enter your choice: ";
+}
+
+void displayDetectionMenu1() {
+    cout << "\n========================================================\n";
+    cout << "            DEADLOCK DETECTION - PHASE 1              \n";
+    cout << "========================================================\n";
+    cout << "  1. Deadlock Detection - Banker's Algorithm           \n";
+    cout << "  2. Deadlock Detection - Wait-For Graph               \n";
+    cout << "  3. Deadlock Detection - Request Matrix (reduction)   \n";
+    cout << "========================================================\n";
+    cout << "Enter your choice: ";
+}
+
+void displayRecoveryMenu() {
+    cout << "\n========================================================\n";
+    cout << "            DEADLOCK RECOVERY - PHASE 2               \n";
+    cout << "========================================================\n";
+    cout << "  1. Recovery Strategy - Process Termination           \n";
+    cout << "  2. Recovery Strategy - Resource Preemption           \n";
+    cout << "  0. Back to Data Menu                                 \n";
+    cout << "========================================================\n";
+    cout << "Enter your choice: ";
+}
+
+// Load a deterministic state that stays mostly safe under single-unit churn: every process
+// may claim two units of each resource and holds up to one, with processes/4 units free
+void loadBenchmarkState(DeadlockDetector& detector, int processes, int resources) {
+    mt19937 stateRng(42u);
+    vector<vector<int>> maximum(processes, vector<int>(resources, 2));
+    vector<vector<int>> allocation(processes, vector<int>(resources, 0));
+    for (auto& row : allocation) for (int& a : row) a = (int)(stateRng() % 2);
+    detector.loadState(vector<int>(resources, max(2, processes / 4)), maximum, allocation);
+}
+
+// Benchmark concurrent admission: worker threads cycle single-unit acquire/release pairs
+// while a reader thread keeps running safety scans on snapshots
+void runConcurrentAdmissionBenchmark(int maxThreads, int processes, int resources, int opsPerThread) {
+    cout << "\n========== CONCURRENT ADMISSION BENCHMARK ==========\n";
+    cout << "Processes: " << processes << ", Resources: " << resources
+         << ", Operations per thread: " << opsPerThread << "\n\n";
+    cout << setw(8) << "Threads" << setw(14) << "Requests/s" << setw(10) << "Granted"
+         << setw(10) << "Scans" << setw(10) << "Speedup" << "\n";
+
+    double baseline = 0.0;
+    for (int threads = 1; threads <= maxThreads; threads *= 2) {
+        DeadlockDetector detector;
+        loadBenchmarkState(detector, processes, resources);
+
+        atomic<bool> done(false);
+        atomic<long long> granted(0);
+        long long scans = 0;
+        thread scanner([&]() {
+            vector<int> safeSeq;
+            while (!done.load()) { detector.isSnapshotSafe(safeSeq); scans++; }
+        });
+
+        auto start = chrono::steady_clock::now();
+        vector<thread> workers;
+        for (int t = 0; t < threads; ++t) {
+            workers.push_back(thread([&, t]() {
+                mt19937 rng(1234u + t);
+                vector<int> unit(resources, 0);
+                long long localGranted = 0;
+                for (int op = 0; op < opsPerThread; ++op) {
+                    int pid = (t + threads * (int)(rng() % processes)) % processes;  // Disjoint slice per thread
+                    int res = (int)(rng() % resources);
+                    unit[res] = 1;
+                    if (detector.admitRequest(pid, unit) == AdmissionResult::Granted) {
+                        localGranted++;
+                        detector.releaseResources(pid, unit);
+                    }
+                    unit[res] = 0;
+                }
+                granted += localGranted;
+            }));
+        }
+        for (thread& w : workers) w.join();
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        done = true;
+        scanner.join();
+
+        double rate = (threads * (double)opsPerThread) / max(seconds, 1e-9);
+        if (threads == 1) baseline = rate;
+        cout << setw(8) << threads << setw(14) << fixed << setprecision(0) << rate
+             << setw(10) << granted.load() << setw(10) << scans
+             << setw(9) << setprecision(2) << rate / baseline << "x\n";
+    }
+    cout.unsetf(ios::fixed);
+    cout << "\n" << metricsRegistry().report(false);
+}
+
+// Measure instrumentation overhead: identical single-thread admission loops with metrics
+// off and on, interleaved over several rounds, comparing the best round of each
+void runMetricsOverheadBenchmark(int processes, int resources, int ops) {
+    cout << "\n========== INSTRUMENTATION OVERHEAD ==========\n";
+    double best[2] = { 1e300, 1e300 };
+    for (int round = 0; round < 7; ++round) {
+        for (int enabled = 0; enabled < 2; ++enabled) {
+            metricsEnabled = (enabled == 1);
+            DeadlockDetector detector;
+            loadBenchmarkState(detector, processes, resources);
+            mt19937 rng(99u);
+            vector<int> unit(resources, 0);
+            auto start = chrono::steady_clock::now();
+            for (int op = 0; op < ops; ++op) {
+                int pid = (int)(rng() % processes), res = (int)(rng() % resources);
+                unit[res] = 1;
+                if (detector.admitRequest(pid, unit) == AdmissionResult::Granted) detector.releaseResources(pid, unit);
+                unit[res] = 0;
+            }
+            best[enabled] = min(best[enabled], chrono::duration<double>(chrono::steady_clock::now() - start).count());
+        }
+    }
+    metricsEnabled = true;
+    cout << fixed << setprecision(0);
+    cout << "Metrics off: " << ops / best[0] << " requests/s\n";
+    cout << "Metrics on:  " << ops / best[1] << " requests/s\n";
+    cout << setprecision(2) << "Overhead:    " << (best[1] / best[0] - 1.0) * 100.0 << "%\n";
+    cout.unsetf(ios::fixed);
+}
+
+#ifdef __linux__
+// ---------------------------------------------------------------------------
+// Daemon mode: binary protocol over a Unix domain socket, served by an epoll loop
+// ---------------------------------------------------------------------------
+
+// Every frame (both directions) is a fixed header followed by `count` int32 values in host
+// byte order; the socket is local so no byte swapping is needed
+struct WireHeader {
+    uint8_t op;          // WireOp (responses echo the request op)
+    uint8_t status;      // Response status, 0 in requests
+    uint16_t reserved;   // Always 0
+    int32_t processId;   // Target process (request/release), -1 otherwise
+    uint32_t count;      // Number of int32 values that follow
+};
+
+enum WireOp : uint8_t { OP_REQUEST = 1, OP_RELEASE = 2, OP_DETECT = 3, OP_SNAPSHOT = 4, OP_STATS = 5, OP_MAX_GRANT = 6,
+                       OP_DETECT_REQUESTS = 7 };
+
+const uint32_t kMaxWireValues = 1u << 20;  // Frames larger than this close the connection
+
+// Append one frame to an output buffer
+void appendFrame(vector<char>& buffer, uint8_t op, uint8_t status, int32_t processId, const vector<int>& values) {
+    WireHeader header = { op, status, 0, processId, (uint32_t)values.size() };
+    const char* h = reinterpret_cast<const char*>(&header);
+    buffer.insert(buffer.end(), h, h + sizeof(header));
+    const char* v = reinterpret_cast<const char*>(values.data());
+    buffer.insert(buffer.end(), v, v + values.size() * sizeof(int32_t));
+}
+
+volatile sig_atomic_t serverStopRequested = 0;
+void handleServerSignal(int) { serverStopRequested = 1; }
+
+// Long-running server that keeps one DeadlockDetector in memory. Request frames that arrive
+// in the same epoll wake-up are admitted together through admitBatch; any other op flushes
+// the pending batch first so each connection observes its commands in order.
+class AdmissionServer {
+private:
+    struct Connection {
+        vector<char> in;     // Bytes received but not yet parsed
+        vector<char> out;    // Responses not yet written
+        bool wantWrite;      // EPOLLOUT currently registered
+        Connection() : wantWrite(false) {}
+    };
+
+    struct PendingRequest {
+        int fd;
+        int processId;
+        vector<int> requestVec;
+    };
+
+    DeadlockDetector& detector;
+    string socketPath;
+    int listenFd;
+    int epollFd;
+    vector<Connection*> connections;     // Indexed by fd
+    vector<PendingRequest> batch;        // Requests waiting for the next batch flush
+    long long framesServed;
+    long long batchesFlushed;
+
+    Connection* connectionFor(int fd) { return fd < (int)connections.size() ? connections[fd] : nullptr; }
+
+    static bool setNonBlocking(int fd) {
+        int flags = fcntl(fd, F_GETFL, 0);
+        return flags >= 0 && fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0;
+    }
+
+    void closeConnection(int fd) {
+        epoll_ctl(epollFd, EPOLL_CTL_DEL, fd, nullptr);
+        close(fd);
+        delete connections[fd];
+        connections[fd] = nullptr;
+    }
+
+    void acceptClients() {
+        while (true) {
+            int fd = accept(listenFd, nullptr, nullptr);
+            if (fd < 0) return;  // EAGAIN: no more pending clients
+            if (!setNonBlocking(fd)) { close(fd); continue; }
+            if (fd >= (int)connections.size()) connections.resize(fd + 1, nullptr);
+            connections[fd] = new Connection();
+            epoll_event ev = {};
+            ev.events = EPOLLIN;
+            ev.data.fd = fd;
+            epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &ev);
+        }
+    }
+
+    // Write as much buffered output as the socket accepts; arm EPOLLOUT for the rest
+    bool flushOutput(int fd) {
+        Connection* conn = connectionFor(fd);
+        if (conn == nullptr) return false;
+        size_t written = 0;
+        while (written < conn->out.size()) {
+            ssize_t n = write(fd, conn->out.data() + written, conn->out.size() - written);
+            if (n > 0) { written += n; continue; }
+            if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+            return false;
+        }
+        conn->out.erase(conn->out.begin(), conn->out.begin() + written);
+        bool wantWrite = !conn->out.empty();
+        if (wantWrite != conn->wantWrite) {
+            epoll_event ev = {};
+            ev.events = EPOLLIN | (wantWrite ? (uint32_t)EPOLLOUT : 0u);
+            ev.data.fd = fd;
+            epoll_ctl(epollFd, EPOLL_CTL_MOD, fd, &ev);
+            conn->wantWrite = wantWrite;
+        }
+        return true;
+    }
+
+    void flushBatch() {
+        if (batch.empty()) return;
+        vector<pair<int, vector<int>>> requests;
+        requests.reserve(batch.size());
+        for (PendingRequest& p : batch) requests.push_back(make_pair(p.processId, p.requestVec));
+        vector<AdmissionResult> results;
+        detector.admitBatch(requests, results);
+        for (size_t k = 0; k < batch.size(); ++k) {
+            Connection* conn = connectionFor(batch[k].fd);
+            if (conn != nullptr) appendFrame(conn->out, OP_REQUEST, (uint8_t)results[k], batch[k].processId, vector<int>());
+        }
+        batch.clear();
+        batchesFlushed++;
+    }
+
+    // Execute one parsed frame; requests are queued for the next batch flush
+    void dispatch(int fd, const WireHeader& header, vector<int>& values) {
+        framesServed++;
+        if (header.op == OP_REQUEST) {
+            PendingRequest pending;
+            pending.fd = fd;
+            pending.processId = header.processId;
+            pending.requestVec.swap(values);
+            batch.push_back(pending);
+            return;
+        }
+
+        flushBatch();
+        Connection* conn = connectionFor(fd);
+        switch (header.op) {
+            case OP_RELEASE: {
+                bool ok = detector.releaseResources(header.processId, values);
+                appendFrame(conn->out, header.op, ok ? 0 : 1, header.processId, vector<int>());
+                break;
+            }
+            case OP_DETECT: {
+                vector<int> safeSeq;
+                bool safe = detector.isSnapshotSafe(safeSeq);
+                appendFrame(conn->out, header.op, safe ? 0 : 1, -1, safeSeq);
+                break;
+            }
+            case OP_SNAPSHOT: {
+                // Layout: n, m, available[m], allocation[n*m], need[n*m]
+                shared_ptr<const StateSnapshot> snap = detector.snapshot();
+                vector<int> out;
+                out.push_back(snap->numProcesses);
+                out.push_back(snap->numResources);
+                out.insert(out.end(), snap->available.begin(), snap->available.end());
+                for (const vector<int>& row : snap->allocation) out.insert(out.end(), row.begin(), row.end());
+                for (const vector<int>& row : snap->need) out.insert(out.end(), row.begin(), row.end());
+                appendFrame(conn->out, header.op, 0, -1, out);
+                break;
+            }
+            case OP_DETECT_REQUESTS: {
+                vector<int> deadlocked;
+                bool clear = detector.detectDeadlockByReduction(deadlocked);
+                appendFrame(conn->out, header.op, clear ? 0 : 1, -1, deadlocked);
+                break;
+            }
+            case OP_MAX_GRANT: {
+                // processId >= 0: values = direction, reply = [k]; processId < 0: reply = n*m table
+                vector<int> out;
+                if (header.processId >= 0) {
+                    int k = detector.maxSafeGrantAlong(header.processId, values);
+                    appendFrame(conn->out, header.op, k < 0 ? 1 : 0, header.processId, vector<int>(1, k));
+                } else {
+                    vector<vector<int>> table = detector.maxSafeGrantAll();
+                    for (const vector<int>& row : table) out.insert(out.end(), row.begin(), row.end());
+                    appendFrame(conn->out, header.op, 0, -1, out);
+                }
+                break;
+            }
+            case OP_STATS: {
+                // Text (or JSON if values[0] == 1) packed into int32 values; processId = byte length
+                string report = metricsRegistry().report(!values.empty() && values[0] == 1);
+                vector<int> packed((report.size() + 3) / 4, 0);
+                if (!report.empty()) memcpy(packed.data(), report.data(), report.size());
+                appendFrame(conn->out, header.op, 0, (int32_t)report.size(), packed);
+                break;
+            }
+            default:
+                appendFrame(conn->out, header.op, 255, -1, vector<int>());
+                break;
+        }
+    }
+
+    // Read everything available and dispatch each complete frame
+    bool readFrames(int fd) {
+        Connection* conn = connectionFor(fd);
+        char chunk[16384];
+        while (true) {
+            ssize_t n = read(fd, chunk, sizeof(chunk));
+            if (n > 0) { conn->in.insert(conn->in.end(), chunk, chunk + n); continue; }
+            if (n == 0) return false;  // Peer closed
+            if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+            return false;
+        }
+
+        size_t offset = 0;
+        while (conn->in.size() - offset >= sizeof(WireHeader)) {
+            WireHeader header;
+            memcpy(&header, conn->in.data() + offset, sizeof(header));
+            if (header.count > kMaxWireValues) return false;
+            size_t frameSize = sizeof(header) + header.count * sizeof(int32_t);
+            if (conn->in.size() - offset < frameSize) break;
+            vector<int> values(header.count);
+            if (header.count > 0) memcpy(values.data(), conn->in.data() + offset + sizeof(header), header.count * sizeof(int32_t));
+            offset += frameSize;
+            dispatch(fd, header, values);
+        }
+        conn->in.erase(conn->in.begin(), conn->in.begin() + offset);
+        return true;
+    }
+
+public:
+    AdmissionServer(DeadlockDetector& detectorRef, const string& path)
+        : detector(detectorRef), socketPath(path), listenFd(-1), epollFd(-1), framesServed(0), batchesFlushed(0) {}
+
+    ~AdmissionServer() {
+        for (size_t fd = 0; fd < connections.size(); ++fd) if (connections[fd]) closeConnection((int)fd);
+        if (epollFd >= 0) close(epollFd);
+        if (listenFd >= 0) { close(listenFd); unlink(socketPath.c_str()); }
+    }
+
+    bool start() {
+        sockaddr_un addr = {};
+        addr.sun_family = AF_UNIX;
+        if (socketPath.size() >= sizeof(addr.sun_path)) {
+            cout << "Error: socket path too long.\n"; return false;
+        }
+        strncpy(addr.sun_path, socketPath.c_str(), sizeof(addr.sun_path) - 1);
+        unlink(socketPath.c_str());
+
+        listenFd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (listenFd < 0 || bind(listenFd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 ||
+            listen(listenFd, 128) < 0 || !setNonBlocking(listenFd)) {
+            cout << "Error: could not listen on " << socketPath << ": " << strerror(errno) << "\n";
+            return false;
+        }
+        epollFd = epoll_create1(0);
+        if (epollFd < 0) { cout << "Error: epoll_create1 failed.\n"; return false; }
+        epoll_event ev = {};
+        ev.events = EPOLLIN;
+        ev.data.fd = listenFd;
+        epoll_ctl(epollFd, EPOLL_CTL_ADD, listenFd, &ev);
+        return true;
+    }
+
+    // Serve until SIGINT/SIGTERM
+    void run() {
+        vector<epoll_event> events(256);
+        vector<int> touched;
+        while (!serverStopRequested) {
+            int ready = epoll_wait(epollFd, events.data(), (int)events.size(), 200);
+            if (ready < 0 && errno != EINTR) break;
+
+            touched.clear();
+            for (int e = 0; e < ready; ++e) {
+                int fd = events[e].data.fd;
+                if (fd == listenFd) { acceptClients(); continue; }
+                if (connectionFor(fd) == nullptr) continue;
+                bool alive = true;
+                if (events[e].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) alive = readFrames(fd);
+                if (!alive) {
+                    // Drop the peer's queued requests before closing it
+                    batch.erase(remove_if(batch.begin(), batch.end(),
+                                          [fd](const PendingRequest& p) { return p.fd == fd; }), batch.end());
+                    closeConnection(fd);
+                    continue;
+                }
+                touched.push_back(fd);
+            }
+            flushBatch();
+            for (int fd : touched) if (connectionFor(fd) && !flushOutput(fd)) closeConnection(fd);
+        }
+        cout << "\nServer stopping. Frames served: " << framesServed << ", batches: " << batchesFlushed << "\n";
+    }
+};
+
+void runAdmissionServer(const string& socketPath, int processes, int resources, const string& journalDir) {
+    DeadlockDetector detector;
+    if (!journalDir.empty()) {
+        if (!detector.openJournal(journalDir)) { cout << "Cannot open journal in " << journalDir << "\n"; return; }
+        cout << detector.journalReport();
+    }
+    if (!detector.isDataLoaded()) {  // Nothing recovered from a journal
+        if (processes > 0 && resources > 0) {
+            loadBenchmarkState(detector, processes, resources);
+        } else if (!detector.readFromFiles()) {
+            return;
+        }
+    }
+
+    signal(SIGINT, handleServerSignal);
+    signal(SIGTERM, handleServerSignal);
+    signal(SIGPIPE, SIG_IGN);
+
+    AdmissionServer server(detector, socketPath);
+    if (!server.start()) return;
+    cout << "Serving " << detector.getNumProcesses() << " processes x " << detector.getNumResources()
+         << " resources on " << socketPath << " (Ctrl+C to stop)\n";
+    server.run();
+}
+
+// Blocking client connection used by the load generator
+class AdmissionClient {
+private:
+    int fd;
+
+    bool readExact(char* dst, size_t len) {
+        while (len > 0) {
+            ssize_t n = read(fd, dst, len);
+            if (n <= 0) { if (n < 0 && errno == EINTR) continue; return false; }
+            dst += n; len -= n;
+        }
+        return true;
+    }
+
+public:
+    AdmissionClient() : fd(-1) {}
+    ~AdmissionClient() { if (fd >= 0) close(fd); }
+
+    bool connectTo(const string& socketPath) {
+        sockaddr_un addr = {};
+        addr.sun_family = AF_UNIX;
+        strncpy(addr.sun_path, socketPath.c_str(), sizeof(addr.sun_path) - 1);
+        fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        return fd >= 0 && connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0;
+    }
+
+    bool sendBuffer(const vector<char>& buffer) {
+        size_t sent = 0;
+        while (sent < buffer.size()) {
+            ssize_t n = write(fd, buffer.data() + sent, buffer.size() - sent);
+            if (n <= 0) { if (n < 0 && errno == EINTR) continue; return false; }
+            sent += n;
+        }
+        return true;
     }
 
-public:
-    // Constructor: Initialize system parameters and seed random generator
-    DeadlockDetector() : numProcesses(0), numResources(0) {
-        srand(static_cast<unsigned>(time(nullptr)));  // Seed for random data generation
+    bool receive(WireHeader& header, vector<int>& values) {
+        if (!readExact(reinterpret_cast<char*>(&header), sizeof(header))) return false;
+        if (header.count > kMaxWireValues) return false;
+        values.resize(header.count);
+        return header.count == 0 || readExact(reinterpret_cast<char*>(values.data()), header.count * sizeof(int32_t));
     }
+};
 
-    // Read system state from input files
-    bool readFromFiles() {
-        // Open required input files
-        ifstream availFile("available.txt");
-        ifstream maxFile("maximum.txt");
-        ifstream allocFile("allocation.txt");
+// Drive the server from several pipelined clients and report throughput and tail latency.
+// Each client cycles single-unit requests on its own slice of processes and releases every
+// unit it was granted.
+void runLoadGenerator(const string& socketPath, int clients, int opsPerClient, int pipelineDepth) {
+    cout << "\n========== ADMISSION SERVER LOAD GENERATOR ==========\n";
+    AdmissionClient probe;
+    WireHeader header;
+    vector<int> values, noValues;
+    vector<char> frame;
+    appendFrame(frame, OP_SNAPSHOT, 0, -1, noValues);
+    if (!probe.connectTo(socketPath) || !probe.sendBuffer(frame) || !probe.receive(header, values) || values.size() < 2) {
+        cout << "Error: could not reach server at " << socketPath << "\n";
+        return;
+    }
+    int processes = values[0], resources = values[1];
+    cout << "Server state: " << processes << " processes x " << resources << " resources\n";
+    cout << "Clients: " << clients << ", operations per client: " << opsPerClient
+         << ", pipeline depth: " << pipelineDepth << "\n";
 
-        // Check if all files opened successfully
-        if (!availFile || !maxFile || !allocFile) {
-            cout << "Error: Could not open one or more input files!\n";
-            cout << "Required files: available.txt, maximum.txt, allocation.txt\n";
-            return false;
+    vector<vector<long long>> latencies(clients);
+    atomic<long long> granted(0), failures(0);
+    auto start = chrono::steady_clock::now();
+    vector<thread> workers;
+    for (int c = 0; c < clients; ++c) {
+        workers.push_back(thread([&, c]() {
+            AdmissionClient client;
+            if (!client.connectTo(socketPath)) { failures++; return; }
+            mt19937 rng(777u + c);
+            vector<long long>& lat = latencies[c];
+            lat.reserve(opsPerClient);
+            vector<pair<int, int>> toRelease;                       // Granted (pid, resource) units
+            vector<pair<int, int>> inFlightUnits;                  // Unit sent with each outstanding request
+            vector<chrono::steady_clock::time_point> inFlightTimes;
+            size_t head = 0;
+            int sent = 0, received = 0;
+            vector<char> out;
+            WireHeader reply;
+            vector<int> replyValues, unit(resources, 0);
+
+            while (received < opsPerClient) {
+                out.clear();
+                while (sent < opsPerClient && sent - received < pipelineDepth) {
+                    int pid, res;
+                    uint8_t op;
+                    if (!toRelease.empty()) {
+                        pid = toRelease.back().first; res = toRelease.back().second;
+                        toRelease.pop_back();
+                        op = OP_RELEASE;
+                    } else {
+                        pid = (c + clients * (int)(rng() % processes)) % processes;
+                        res = (int)(rng() % resources);
+                        op = OP_REQUEST;
+                    }
+                    unit[res] = 1;
+                    appendFrame(out, op, 0, pid, unit);
+                    unit[res] = 0;
+                    inFlightUnits.push_back(make_pair(op == OP_REQUEST ? pid : -1, res));
+                    inFlightTimes.push_back(chrono::steady_clock::now());
+                    sent++;
+                }
+                if (!out.empty() && !client.sendBuffer(out)) { failures++; return; }
+                if (!client.receive(reply, replyValues)) { failures++; return; }
+                lat.push_back(chrono::duration_cast<chrono::nanoseconds>(
+                    chrono::steady_clock::now() - inFlightTimes[head]).count());
+                if (reply.op == OP_REQUEST && reply.status == (uint8_t)AdmissionResult::Granted) {
+                    granted++;
+                    toRelease.push_back(inFlightUnits[head]);
+                }
+                head++;
+                received++;
+            }
+            // Return anything still held so repeated runs start from the same state
+            for (const pair<int, int>& held : toRelease) {
+                unit[held.second] = 1;
+                out.clear();
+                appendFrame(out, OP_RELEASE, 0, held.first, unit);
+                unit[held.second] = 0;
+                if (!client.sendBuffer(out) || !client.receive(reply, replyValues)) break;
+            }
+        }));
+    }
+    for (thread& w : workers) w.join();
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    vector<long long> all;
+    for (const vector<long long>& lat : latencies) all.insert(all.end(), lat.begin(), lat.end());
+    if (all.empty()) { cout << "No operations completed (" << failures.load() << " client failures).\n"; return; }
+    sort(all.begin(), all.end());
+    auto percentile = [&](double q) { return all[min(all.size() - 1, (size_t)(q * all.size()))] / 1000.0; };
+
+    cout << fixed << setprecision(1);
+    cout << "\nOperations:      " << all.size() << " (" << granted.load() << " grants, "
+         << failures.load() << " client failures)\n";
+    cout << "Throughput:      " << all.size() / max(seconds, 1e-9) << " ops/s\n";
+    cout << "Latency (us):    p50 " << percentile(0.50) << "  p99 " << percentile(0.99)
+         << "  p99.9 " << percentile(0.999) << "  max " << all.back() / 1000.0 << "\n";
+    cout.unsetf(ios::fixed);
+
+    frame.clear();
+    appendFrame(frame, OP_STATS, 0, -1, noValues);
+    if (probe.sendBuffer(frame) && probe.receive(header, values) && header.processId >= 0 &&
+        (size_t)header.processId <= values.size() * 4) {
+        cout << "\nServer-side statistics:\n" << string(reinterpret_cast<const char*>(values.data()), header.processId);
+    }
+}
+#endif
+
+// Compare the max-safe-grant query with the probing it replaces: shrinking single-resource
+// requests, each a full admission that is released again when granted
+void runMaxGrantBenchmark(int processes, int resources) {
+    cout << "\n========== MAX SAFE GRANT QUERY ==========\n";
+    mt19937 rng(7u);
+    vector<vector<int>> maximum(processes, vector<int>(resources, 0));
+    vector<vector<int>> allocation(processes, vector<int>(resources, 0));
+    for (int i = 0; i < processes; ++i) {
+        for (int j = 0; j < resources; ++j) {
+            maximum[i][j] = (int)(rng() % 11);
+            allocation[i][j] = (int)(rng() % (maximum[i][j] / 2 + 1));
         }
+    }
+    DeadlockDetector detector;
+    detector.loadState(vector<int>(resources, 10), maximum, allocation);
+    cout << "Processes: " << processes << ", Resources: " << resources << "\n";
 
-        // Read available resources from file
-        int fileNumResources = 0;
-        if (!(availFile >> fileNumResources)) {
-            cout << "Error reading available.txt header.\n";
-            return false;
+    auto start = chrono::steady_clock::now();
+    vector<vector<int>> probed(processes, vector<int>(resources, 0));
+    shared_ptr<const StateSnapshot> snap = detector.snapshot();
+    vector<int> req(resources, 0);
+    for (int i = 0; i < processes; ++i) {
+        for (int j = 0; j < resources; ++j) {
+            for (int k = min(snap->need[i][j], snap->available[j]); k > 0; --k) {
+                req[j] = k;
+                if (detector.admitRequest(i, req) == AdmissionResult::Granted) {
+                    detector.releaseResources(i, req);
+                    probed[i][j] = k;
+                    break;
+                }
+            }
+            req[j] = 0;
         }
-        numResources = fileNumResources;
-        available.assign(numResources, 0);
-        for (int i = 0; i < numResources; ++i) {
-            if (!(availFile >> available[i])) {
-                cout << "Error: available.txt does not contain enough resource values.\n";
-                return false;
+    }
+    double probeSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    start = chrono::steady_clock::now();
+    vector<vector<int>> serial(processes, vector<int>(resources, 0));
+    for (int i = 0; i < processes; ++i) {
+        for (int j = 0; j < resources; ++j) serial[i][j] = detector.maxSafeGrant(i, j);
+    }
+    double querySeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    start = chrono::steady_clock::now();
+    vector<vector<int>> bulk = detector.maxSafeGrantAll();
+    double bulkSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    long long grantable = 0;
+    for (const vector<int>& row : bulk) for (int k : row) grantable += k;
+    cout << "Total grantable units across all pairs: " << grantable << "\n";
+    cout << fixed << setprecision(3);
+    cout << "Probing with requestResources-style admissions: " << probeSeconds * 1000 << " ms\n";
+    cout << "maxSafeGrant (binary search, per pair):         " << querySeconds * 1000 << " ms\n";
+    cout << "maxSafeGrantAll (parallel bulk):                " << bulkSeconds * 1000 << " ms\n";
+    cout.unsetf(ios::fixed);
+    cout << "Results " << (probed == serial && serial == bulk ? "match" : "DIFFER") << " across all three.\n";
+}
+
+// Acquire/release cycling revisits the same few states, so compare admission throughput with
+// the verdict cache off and on. Resource R0 is chained so that only P(n-1) can finish first,
+// then P(n-2), and so on: every safety pass needs n sweeps, the O(n^2 m) worst case.
+void runVerdictCacheBenchmark(int processes, int resources, int ops, int capacity) {
+    cout << "\n========== VERDICT CACHE BENCHMARK ==========\n";
+    cout << "Processes: " << processes << ", Resources: " << resources << ", Operations: " << ops
+         << ", Capacity: " << capacity << "\n\n";
+    if (resources < 2) { cout << "Need at least 2 resources.\n"; return; }
+
+    vector<vector<int>> maximum(processes, vector<int>(resources, 2));
+    vector<vector<int>> allocation(processes, vector<int>(resources, 0));
+    vector<int> available(resources, processes);
+    for (int i = 0; i < processes; ++i) {
+        allocation[i][0] = 1;
+        maximum[i][0] = processes - i + 1;  // Need on R0 is n - i
+    }
+    available[0] = 1;
+
+    double rate[2] = { 0, 0 };
+    for (int cached = 0; cached < 2; ++cached) {
+        DeadlockDetector detector;
+        detector.loadState(available, maximum, allocation);
+        if (cached) detector.enableVerdictCache(capacity);
+        mt19937 rng(5u);
+        vector<int> unit(resources, 0);
+        long long grantedCount = 0;
+        auto start = chrono::steady_clock::now();
+        for (int op = 0; op < ops; ++op) {
+            int pid = (int)(rng() % processes), res = 1 + (int)(rng() % (resources - 1));
+            unit[res] = 1;
+            if (detector.admitRequest(pid, unit) == AdmissionResult::Granted) {
+                grantedCount++;
+                detector.releaseResources(pid, unit);
             }
+            unit[res] = 0;
         }
+        rate[cached] = ops / max(chrono::duration<double>(chrono::steady_clock::now() - start).count(), 1e-9);
+        cout << (cached ? "Cache on:  " : "Cache off: ") << fixed << setprecision(0) << rate[cached]
+             << " requests/s, " << grantedCount << " granted\n";
+        cout.unsetf(ios::fixed);
+        if (cached) cout << detector.verdictCacheReport();
+    }
+    cout << "Speedup: " << fixed << setprecision(2) << rate[1] / rate[0] << "x\n";
+    cout.unsetf(ios::fixed);
+}
 
-        int fileNumProcesses = 0, fileNumResources2 = 0;
-        if (!(maxFile >> fileNumProcesses >> fileNumResources2)) {
-            cout << "Error reading maximum.txt header. Expect: <numProcesses> <numResources>\n";
-            return false;
+// Compare request-matrix reduction with the Banker's avoidance check used as a detector:
+// cost per scan and how often Banker's reports an unsafe state with no actual deadlock
+// Chained state: every process waits on R0 and only the last one can finish first, so Banker's
+// needs one sweep per process while the reduction walks the chain once
+void loadChainedState(DeadlockDetector& detector, int processes, int resources) {
+    vector<vector<int>> maximum(processes, vector<int>(resources, 0));
+    vector<vector<int>> allocation(processes, vector<int>(resources, 0));
+    vector<vector<int>> requestMat(processes, vector<int>(resources, 0));
+    vector<int> available(resources, 0);
+    for (int i = 0; i < processes; ++i) {
+        allocation[i][0] = 1;
+        maximum[i][0] = processes - i + 1;
+        requestMat[i][0] = processes - i;
+    }
+    available[0] = 1;
+    detector.loadState(available, maximum, allocation, &requestMat);
+}
+
+// One table row: average time per scan of both detectors over the states make() builds
+void compareDetectorsOn(const string& label, int trials, const function<void(DeadlockDetector&)>& make) {
+    double reductionSeconds = 0, bankersSeconds = 0;
+    int unsafeStates = 0, deadlockedStates = 0;
+    vector<int> deadlocked, safeSeq;
+    for (int t = 0; t < trials; ++t) {
+        DeadlockDetector detector;
+        make(detector);
+        detector.snapshot();  // Publish the snapshot outside the timed region
+
+        auto start = chrono::steady_clock::now();
+        bool clear = detector.detectDeadlockByReduction(deadlocked);
+        reductionSeconds += chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+        start = chrono::steady_clock::now();
+        bool safe = detector.isSnapshotSafe(safeSeq);
+        bankersSeconds += chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+        if (!safe) unsafeStates++;
+        if (!clear) deadlockedStates++;
+    }
+    cout << setw(26) << left << label << right << fixed << setprecision(2)
+         << setw(14) << reductionSeconds / trials * 1e6 << setw(14) << bankersSeconds / trials * 1e6
+         << setw(9) << reductionSeconds / max(1e-12, bankersSeconds) << "x"
+         << setw(12) << deadlockedStates << setw(9) << unsafeStates << "\n";
+    cout.unsetf(ios::fixed);
+}
+
+// Reduction vs Banker's on random states (mostly unsafe: Banker's stops after its first
+// fruitless sweep, so it wins there) and on chains, where Banker's pays one sweep per process
+void runDetectionComparison(int processes, int resources, int trials) {
+    cout << "\n========== DETECTION: REDUCTION VS BANKER'S ==========\n";
+    cout << "Processes: " << processes << ", Resources: " << resources << ", Trials: " << trials << "\n\n";
+    cout << setw(26) << left << "Workload" << right << setw(14) << "Reduction us" << setw(14) << "Banker's us"
+         << setw(10) << "Ratio" << setw(12) << "Deadlocked" << setw(9) << "Unsafe" << "\n";
+    mt19937 rng(11u);  // Fixed seed: every run measures the same states
+    for (int scale = 1; scale <= 16; scale *= 4) {
+        int p = processes * scale;
+        compareDetectorsOn("random " + to_string(p) + "x" + to_string(resources), max(1, trials / scale),
+                           [&](DeadlockDetector& d) { d.generateRandomState(p, resources, rng); });
+    }
+    for (int scale = 1; scale <= 16; scale *= 4) {
+        int p = processes * scale;
+        compareDetectorsOn("chain " + to_string(p) + "x" + to_string(resources), max(1, trials / scale),
+                           [&](DeadlockDetector& d) { loadChainedState(d, p, resources); });
+    }
+    cout << "\nRatio is reduction time over Banker's time (below 1 means the reduction is cheaper).\n";
+    cout << "Unsafe counts are Banker's alarms; only the deadlocked ones are real.\n";
+}
+
+// Remove journal files left in a directory by an earlier run
+void clearJournalFiles(const string& directory) {
+    remove(journalSnapshotPath(directory).c_str());
+    remove((journalSnapshotPath(directory) + ".tmp").c_str());
+    for (uint64_t segment = 1, misses = 0; misses < 64; ++segment) {
+        misses = remove(journalSegmentPath(directory, segment).c_str()) == 0 ? 0 : misses + 1;
+    }
+}
+
+// Single-unit acquire/release pairs spread over threads; returns requests per second
+double runJournaledAdmissions(DeadlockDetector& detector, int threads, int opsPerThread) {
+    int processes = detector.getNumProcesses(), resources = detector.getNumResources();
+    auto start = chrono::steady_clock::now();
+    vector<thread> workers;
+    for (int t = 0; t < threads; ++t) {
+        workers.push_back(thread([&, t]() {
+            mt19937 rng(1234u + t);
+            vector<int> unit(resources, 0);
+            for (int op = 0; op < opsPerThread; ++op) {
+                int pid = (t + threads * (int)(rng() % processes)) % processes;
+                int res = (int)(rng() % resources);
+                unit[res] = 1;
+                if (detector.admitRequest(pid, unit) == AdmissionResult::Granted) detector.releaseResources(pid, unit);
+                unit[res] = 0;
+            }
+        }));
+    }
+    for (thread& w : workers) w.join();
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    return threads * (double)opsPerThread / max(seconds, 1e-9);
+}
+
+// Benchmark journal overhead and restart time: admissions without a journal, with an async
+// journal and with sync group commit from several threads, then recovery from a long journal
+// tail and from a fresh snapshot
+void runJournalBenchmark(const string& directory, int processes, int resources, int ops, int threads) {
+    cout << "\n========== JOURNAL BENCHMARK ==========\n";
+    cout << "Directory: " << directory << ", Processes: " << processes << ", Resources: " << resources
+         << ", Operations: " << ops << "\n\n";
+    if (!makeDirectory(directory)) { cout << "Cannot create " << directory << "\n"; return; }
+    clearJournalFiles(directory);
+    cout << fixed << setprecision(0);
+
+    double plain, async;
+    {
+        DeadlockDetector detector;
+        loadBenchmarkState(detector, processes, resources);
+        plain = runJournaledAdmissions(detector, 1, ops);
+    }
+    StateHash expected;
+    {
+        DeadlockDetector detector;
+        loadBenchmarkState(detector, processes, resources);
+        if (!detector.openJournal(directory, JournalMode::Async, UINT64_MAX)) { cout << "Cannot open journal\n"; return; }
+        async = runJournaledAdmissions(detector, 1, ops);
+        expected = detector.currentStateHash();
+        cout << "No journal:          " << setw(10) << plain << " requests/s\n";
+        cout << "Async journal:       " << setw(10) << async << " requests/s ("
+             << setprecision(1) << 100.0 * async / plain << "% of no journal)\n" << setprecision(0);
+    }
+
+    // Restart with the whole run as journal tail, then again from a snapshot
+    for (int pass = 0; pass < 2; ++pass) {
+        DeadlockDetector detector;
+        auto start = chrono::steady_clock::now();
+        bool opened = detector.openJournal(directory, JournalMode::Async, UINT64_MAX);
+        double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+        StateHash recovered = detector.currentStateHash();
+        cout << (pass == 0 ? "Restart from journal: " : "Restart from snapshot:") << setw(9) << setprecision(2) << ms
+             << " ms, state " << (opened && recovered == expected ? "matches" : "DIFFERS") << "\n" << setprecision(0);
+        if (pass == 0) detector.checkpoint();
+    }
+    clearJournalFiles(directory);
+
+    {
+        DeadlockDetector detector;
+        loadBenchmarkState(detector, processes, resources);
+        if (!detector.openJournal(directory, JournalMode::Sync, UINT64_MAX)) { cout << "Cannot open journal\n"; return; }
+        double sync = runJournaledAdmissions(detector, threads, max(1, ops / (threads * 10)));
+        cout << "Sync journal (" << threads << " threads): " << setw(8) << sync << " requests/s\n";
+        cout.unsetf(ios::fixed);
+        cout << "\n" << detector.journalReport();
+    }
+    clearJournalFiles(directory);
+}
+
+// Messages between simulated nodes. Probes follow the Chandy-Misra-Haas AND-model protocol;
+// gather messages implement the centralized baseline.
+enum ClusterMessageKind { MSG_PROBE_TO_SITE, MSG_PROBE_TO_HOME, MSG_GATHER_REQUEST, MSG_GATHER_REPLY };
+
+struct ClusterMessage {
+    ClusterMessageKind kind;
+    int from;                                   // Sending node
+    int initiator;                              // Probe: process that started it
+    int process;                                // Probe: process the probe has reached
+    shared_ptr<const StateSnapshot> state;      // Gather reply: the sender's local state
+    chrono::steady_clock::time_point deliverAt; // Simulated link delay for remote messages
+};
+
+// Message counts and latency of one detection round
+struct ClusterRoundStats {
+    long long messages;        // All messages, including node-local ones
+    long long remoteMessages;  // Messages that crossed nodes
+    long long remoteBytes;     // Payload bytes that crossed nodes
+    double seconds;            // From start of the round until no message is in flight
+    vector<int> deadlocked;    // Processes reported deadlocked, sorted
+};
+
+// Several nodes in one process, each with its own DeadlockDetector over its share of the
+// resources. Process p is homed on node p % nodes; the home learns where p is blocked
+// (as it would when forwarding p's requests) and forwards probes about p to those nodes,
+// which forward them to the local holders' homes. A probe that returns to its initiator
+// proves a cycle. Every node runs a worker thread draining its inbox.
+class SimulatedCluster {
+private:
+    struct Node {
+        DeadlockDetector detector;               // All processes x this node's resources
+        mutex inboxMutex;
+        condition_variable inboxReady;
+        deque<ClusterMessage> inbox;
+        thread worker;
+        vector<vector<int>> waitsFor;            // Round state: local holders each process waits for
+        vector<vector<int>> waitSites;           // Round state: nodes where each homed process is blocked
+        unordered_set<uint64_t> probed;          // Round state: (initiator, process) pairs seen here
+        vector<shared_ptr<const StateSnapshot>> gathered;  // Coordinator only
+    };
+
+    vector<unique_ptr<Node>> nodes;
+    int numProcesses;
+    chrono::microseconds linkDelay;
+    bool priorityPruning;                        // Forward a probe only to processes below its initiator
+
+    atomic<long long> inFlight, messages, remoteMessages, remoteBytes;
+    atomic<bool> stopping;
+    mutex roundMutex;
+    condition_variable roundDone;
+    vector<int> detected;                        // Guarded by roundMutex
+
+    int homeOf(int process) const { return process % (int)nodes.size(); }
+
+    void send(int from, int to, ClusterMessage message) {
+        message.from = from;
+        message.deliverAt = chrono::steady_clock::now();
+        messages++;
+        if (from != to) {
+            remoteMessages++;
+            message.deliverAt += linkDelay;
+            if (message.kind == MSG_GATHER_REPLY) {
+                const StateSnapshot& s = *message.state;
+                remoteBytes += 8 + 4 * (s.numResources + 2LL * s.numProcesses * s.numResources);
+            } else {
+                remoteBytes += 12;
+            }
         }
-        if (fileNumResources2 != numResources) {
-            cout << "Warning: numResources in maximum.txt (" << fileNumResources2
-                 << ") differs from available.txt (" << numResources << "). Using maximum.txt value.\n";
-            numResources = fileNumResources2;
+        inFlight++;
+        Node& node = *nodes[to];
+        lock_guard<mutex> lock(node.inboxMutex);
+        node.inbox.push_back(message);
+        node.inboxReady.notify_one();
+    }
+
+    void reportDeadlocked(const vector<int>& processes) {
+        lock_guard<mutex> lock(roundMutex);
+        detected.insert(detected.end(), processes.begin(), processes.end());
+    }
+
+    void handle(int self, const ClusterMessage& message) {
+        Node& node = *nodes[self];
+        ClusterMessage next = message;
+        switch (message.kind) {
+            case MSG_PROBE_TO_SITE:
+                next.kind = MSG_PROBE_TO_HOME;
+                for (int holder : node.waitsFor[message.process]) {
+                    if (priorityPruning && holder > message.initiator) continue;
+                    next.process = holder;
+                    send(self, homeOf(holder), next);
+                }
+                break;
+            case MSG_PROBE_TO_HOME:
+                if (message.process == message.initiator) { reportDeadlocked(vector<int>(1, message.initiator)); break; }
+                if (!node.probed.insert(((uint64_t)message.initiator << 32) | (uint32_t)message.process).second) break;
+                next.kind = MSG_PROBE_TO_SITE;
+                for (int site : node.waitSites[message.process]) send(self, site, next);
+                break;
+            case MSG_GATHER_REQUEST:
+                next.kind = MSG_GATHER_REPLY;
+                next.state = node.detector.snapshot();
+                send(self, message.from, next);
+                break;
+            case MSG_GATHER_REPLY: {
+                node.gathered.push_back(message.state);
+                if (node.gathered.size() < nodes.size()) break;
+                vector<vector<int>> edges(numProcesses);
+                for (const shared_ptr<const StateSnapshot>& s : node.gathered) {
+                    vector<vector<int>> local = buildWaitEdges(*s);
+                    for (int i = 0; i < numProcesses; ++i) edges[i].insert(edges[i].end(), local[i].begin(), local[i].end());
+                }
+                node.gathered.clear();
+                vector<int> component = processesOnCycles(edges), cyclic;
+                for (int i = 0; i < numProcesses; ++i) if (component[i] >= 0) cyclic.push_back(i);
+                reportDeadlocked(cyclic);
+                break;
+            }
         }
-        numProcesses = fileNumProcesses;
-        maximum.assign(numProcesses, vector<int>(numResources, 0));
-        for (int i = 0; i < numProcesses; ++i) {
-            for (int j = 0; j < numResources; ++j) {
-                if (!(maxFile >> maximum[i][j])) {
-                    cout << "Error: maximum.txt does not contain enough matrix values.\n";
-                    return false;
+    }
+
+    void workerLoop(int self) {
+        Node& node = *nodes[self];
+        while (true) {
+            ClusterMessage message;
+            {
+                unique_lock<mutex> lock(node.inboxMutex);
+                while (!stopping.load() && (node.inbox.empty() || node.inbox.front().deliverAt > chrono::steady_clock::now())) {
+                    if (node.inbox.empty()) node.inboxReady.wait(lock);
+                    else node.inboxReady.wait_until(lock, node.inbox.front().deliverAt);
                 }
+                if (stopping.load()) return;
+                message = node.inbox.front();
+                node.inbox.pop_front();
             }
+            handle(self, message);
+            if (--inFlight == 0) {
+                lock_guard<mutex> lock(roundMutex);
+                roundDone.notify_all();
+            }
+        }
+    }
+
+    ClusterRoundStats finishRound(chrono::steady_clock::time_point start) {
+        unique_lock<mutex> lock(roundMutex);
+        roundDone.wait(lock, [&]() { return inFlight.load() == 0; });
+        ClusterRoundStats stats;
+        stats.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        stats.messages = messages.load();
+        stats.remoteMessages = remoteMessages.load();
+        stats.remoteBytes = remoteBytes.load();
+        sort(detected.begin(), detected.end());
+        detected.erase(unique(detected.begin(), detected.end()), detected.end());
+        stats.deadlocked.swap(detected);
+        return stats;
+    }
+
+    void beginRound() {
+        messages = remoteMessages = remoteBytes = 0;
+        lock_guard<mutex> lock(roundMutex);
+        detected.clear();
+    }
+
+public:
+    SimulatedCluster(int nodeCount, int processes, int linkDelayUs)
+        : numProcesses(processes), linkDelay(linkDelayUs), priorityPruning(false), inFlight(0), messages(0),
+          remoteMessages(0), remoteBytes(0), stopping(false) {
+        for (int k = 0; k < nodeCount; ++k) nodes.push_back(unique_ptr<Node>(new Node()));
+        for (int k = 0; k < nodeCount; ++k) nodes[k]->worker = thread(&SimulatedCluster::workerLoop, this, k);
+    }
+
+    ~SimulatedCluster() {
+        stopping = true;
+        for (unique_ptr<Node>& node : nodes) {
+            { lock_guard<mutex> lock(node->inboxMutex); }
+            node->inboxReady.notify_all();
+            node->worker.join();
         }
+    }
 
-        int allocP = 0, allocR = 0;
-        if (!(allocFile >> allocP >> allocR)) {
-            cout << "Error reading allocation.txt header. Expect: <numProcesses> <numResources>\n";
-            return false;
+    int nodeCount() const { return (int)nodes.size(); }
+    DeadlockDetector& detectorAt(int node) { return nodes[node]->detector; }
+
+    // Edge-chasing round: every blocked process initiates a probe. With pruning, a probe is
+    // only forwarded to lower-numbered processes, so each cycle is found once, by its highest
+    // member, instead of by every member.
+    ClusterRoundStats detectByProbes(bool pruned) {
+        beginRound();
+        priorityPruning = pruned;
+        auto start = chrono::steady_clock::now();
+        int n = (int)nodes.size();
+        for (int k = 0; k < n; ++k) {
+            nodes[k]->waitsFor = buildWaitEdges(*nodes[k]->detector.snapshot());
+            nodes[k]->waitSites.assign(numProcesses, vector<int>());
+            nodes[k]->probed.clear();
         }
-        if (allocP != numProcesses || allocR != numResources) {
-            cout << "Warning: allocation.txt dimensions (" << allocP << "x" << allocR
-                 << ") differ from maximum.txt (" << numProcesses << "x" << numResources << ").\n";
-            if (allocP > 0) numProcesses = allocP;
-            if (allocR > 0) numResources = allocR;
-            maximum.assign(numProcesses, vector<int>(numResources, 0)); 
-            allocFile.clear();
-            allocFile.seekg(0);
-            if (!(allocFile >> allocP >> allocR)) return false; 
+        for (int k = 0; k < n; ++k) {
+            for (int i = 0; i < numProcesses; ++i) {
+                if (!nodes[k]->waitsFor[i].empty()) nodes[homeOf(i)]->waitSites[i].push_back(k);
+            }
         }
 
-        allocation.assign(numProcesses, vector<int>(numResources, 0));
+        inFlight++;  // Hold the round open while probes are injected
+        ClusterMessage probe = ClusterMessage();
+        probe.kind = MSG_PROBE_TO_SITE;
         for (int i = 0; i < numProcesses; ++i) {
-            for (int j = 0; j < numResources; ++j) {
-                if (!(allocFile >> allocation[i][j])) {
-                    cout << "Error: allocation.txt does not contain enough matrix values.\n";
-                    return false;
-                }
-            }
+            probe.initiator = probe.process = i;
+            for (int site : nodes[homeOf(i)]->waitSites[i]) send(homeOf(i), site, probe);
+        }
+        if (--inFlight == 0) {
+            lock_guard<mutex> lock(roundMutex);
+            roundDone.notify_all();
+        }
+        return finishRound(start);
+    }
+
+    // Baseline: node 0 gathers every node's state and searches one global wait-for graph
+    ClusterRoundStats detectCentrally() {
+        beginRound();
+        auto start = chrono::steady_clock::now();
+        inFlight++;
+        ClusterMessage request = ClusterMessage();
+        request.kind = MSG_GATHER_REQUEST;
+        for (int k = 0; k < (int)nodes.size(); ++k) send(0, k, request);
+        if (--inFlight == 0) {
+            lock_guard<mutex> lock(roundMutex);
+            roundDone.notify_all();
+        }
+        return finishRound(start);
+    }
+};
+
+// Random single-unit state spread over the cluster: resource r lives on node r % nodes,
+// most resources are held, and about half the processes wait for one or two held resources
+void loadClusterState(SimulatedCluster& cluster, int processes, int resources, mt19937& rng) {
+    int n = cluster.nodeCount();
+    vector<int> holder(resources, -1);
+    for (int r = 0; r < resources; ++r) if (rng() % 5 != 0) holder[r] = (int)(rng() % processes);
+    vector<vector<int>> waits(processes);
+    for (int i = 0; i < processes; ++i) {
+        if (rng() % 2) continue;
+        int count = rng() % 5 == 0 ? 2 : 1;
+        for (int c = 0; c < count; ++c) {
+            int r = (int)(rng() % resources);
+            if (holder[r] >= 0 && holder[r] != i) waits[i].push_back(r);
+        }
+    }
+    for (int k = 0; k < n; ++k) {
+        int local = (resources - k + n - 1) / n;   // Resources k, k + n, k + 2n, ...
+        vector<int> available(local, 0);
+        vector<vector<int>> allocation(processes, vector<int>(local, 0)), request = allocation;
+        for (int j = 0; j < local; ++j) {
+            int r = k + j * n;
+            if (holder[r] < 0) available[j] = 1; else allocation[holder[r]][j] = 1;
+        }
+        for (int i = 0; i < processes; ++i) {
+            for (int r : waits[i]) if (r % n == k) request[i][r / n] = 1;
         }
+        vector<vector<int>> maximum = allocation;
+        for (int i = 0; i < processes; ++i) for (int j = 0; j < local; ++j) maximum[i][j] += request[i][j];
+        cluster.detectorAt(k).loadState(available, maximum, allocation, &request);
+    }
+}
 
-        if ((int)available.size() != numResources) available.assign(numResources, 0);
+// Compare edge-chasing with central gathering as the node count grows. Latency includes a
+// simulated one-way link delay on every message that crosses nodes.
+void runDistributedDetectionBenchmark(int processes, int resources, int trials, int linkDelayUs, int maxNodes) {
+    cout << "\n========== DISTRIBUTED DETECTION: EDGE CHASING VS CENTRAL ==========\n";
+    cout << "Processes: " << processes << ", Resources: " << resources << ", Link delay: " << linkDelayUs
+         << " us, Trials: " << trials << "\n\n";
+    cout << setw(6) << "Nodes" << setw(12) << "Probe msgs" << setw(10) << "Remote" << setw(11) << "Latency"
+         << setw(12) << "Pruned msgs" << setw(10) << "Remote" << setw(11) << "Latency"
+         << setw(14) << "Central msgs" << setw(10) << "Bytes" << setw(11) << "Latency" << setw(10) << "Agree" << "\n";
+    cout << fixed;
+    for (int n = 1; n <= maxNodes && n <= resources; n *= 2) {
+        SimulatedCluster cluster(n, processes, linkDelayUs);
+        mt19937 rng(77u);
+        double sums[3][3] = {};   // [full, pruned, central][messages, remote (bytes for central), seconds]
+        int agree = 0;
+        for (int t = 0; t < trials; ++t) {
+            loadClusterState(cluster, processes, resources, rng);
+            ClusterRoundStats full = cluster.detectByProbes(false);
+            ClusterRoundStats pruned = cluster.detectByProbes(true);
+            ClusterRoundStats central = cluster.detectCentrally();
 
-        calculateNeed();
+            // Full probing reports exactly the processes on cycles; pruning reports at least
+            // one member of every cycle and nothing else
+            vector<int> component(processes, -1);
+            vector<vector<int>> edges(processes);
+            for (int k = 0; k < n; ++k) {
+                vector<vector<int>> local = buildWaitEdges(*cluster.detectorAt(k).snapshot());
+                for (int i = 0; i < processes; ++i) edges[i].insert(edges[i].end(), local[i].begin(), local[i].end());
+            }
+            component = processesOnCycles(edges);
+            set<int> covered;
+            bool ok = full.deadlocked == central.deadlocked;
+            for (int p : pruned.deadlocked) { ok = ok && component[p] >= 0; covered.insert(component[p]); }
+            for (int p : central.deadlocked) ok = ok && covered.count(component[p]) > 0;
+            if (ok) agree++;
 
-        availFile.close();
-        maxFile.close();
-        allocFile.close();
-        return true;
+            const ClusterRoundStats* rounds[] = { &full, &pruned, &central };
+            for (int v = 0; v < 3; ++v) {
+                sums[v][0] += rounds[v]->messages;
+                sums[v][1] += v == 2 ? rounds[v]->remoteBytes : rounds[v]->remoteMessages;
+                sums[v][2] += rounds[v]->seconds;
+            }
+        }
+        cout << setw(6) << n << setprecision(0)
+             << setw(12) << sums[0][0] / trials << setw(10) << sums[0][1] / trials
+             << setw(9) << setprecision(2) << sums[0][2] / trials * 1e3 << "ms" << setprecision(0)
+             << setw(12) << sums[1][0] / trials << setw(10) << sums[1][1] / trials
+             << setw(9) << setprecision(2) << sums[1][2] / trials * 1e3 << "ms" << setprecision(0)
+             << setw(14) << sums[2][0] / trials << setw(10) << sums[2][1] / trials
+             << setw(9) << setprecision(2) << sums[2][2] / trials * 1e3 << "ms"
+             << setw(7) << agree << "/" << trials << "\n";
     }
+    cout.unsetf(ios::fixed);
+}
 
-    // Get system state through user input
-    bool inputFromUser() {
-        cout << "\n========== USER INPUT MODE ==========\n";
+// Change to the system state fed to the monitor
+enum class DeltaKind { Request, Release, Arrival, Exit };
 
-        cout << "Enter number of processes: ";
-        if (!(cin >> numProcesses)) { cin.clear(); cin.ignore(INT_MAX,'\n'); return false; }
+struct StateDelta {
+    DeltaKind kind;
+    int processId;                               // Request, Release, Exit
+    vector<int> values;                          // Request/release vector, or an arrival's maximum claim
+    chrono::steady_clock::time_point submitted;  // Set by submit()
+};
 
-        cout << "Enter number of resources: ";
-        if (!(cin >> numResources)) { cin.clear(); cin.ignore(INT_MAX,'\n'); return false; }
+// CPU time consumed by the calling thread
+double threadCpuSeconds() {
+#ifdef __linux__
+    timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+#else
+    return (double)clock() / CLOCKS_PER_SEC;
+#endif
+}
 
-        if (numProcesses <= 0 || numResources <= 0) {
-            cout << "Invalid input! Values must be positive.\n";
-            return false;
-        }
+// Keeps a detector resident and applies queued deltas once per tick, then decides whether
+// the tick needs any detection at all:
+//  - safety (Banker's) is only re-checked when an arrival claims more than the total
+//    instances, or when an unsafe state may have been repaired by releases or exits: grants
+//    are admitted only when safe, releases and exits never make a safe state unsafe, and a
+//    newcomer can always run last in the existing safe sequence;
+//  - deadlock is only re-checked when a request had to wait, or when known deadlocked
+//    processes may have been freed by releases or exits. The reduction is focused on those
+//    processes and stops as soon as all of them can proceed.
+// With deltaDriven off, every tick runs both checks over the whole state (baseline).
+class DeadlockMonitor {
+private:
+    DeadlockDetector& detector;
+    chrono::microseconds tickPeriod;
+    bool deltaDriven;
 
-        vector<int> totalResources(numResources);
-        cout << "\nEnter total instances of each resource:\n";
-        for (int i = 0; i < numResources; i++) {
-            cout << "Resource R" << i << ": ";
-            cin >> totalResources[i];
-            if (totalResources[i] < 0) totalResources[i] = 0;
+    mutex queueMutex;
+    vector<StateDelta> queue;
+    thread loop;
+    atomic<bool> running;
+
+    // Monitor thread only
+    vector<int> deadlocked;                      // Result of the latest deadlock check
+    bool safe;
+    uint64_t ticks, idleTicks, skippedTicks, safetyChecks, reductions, deadlockEvents, deltasApplied;
+    double cpuSeconds, checkSeconds;
+    LatencyHistogram detectionLatency;           // Submission to verdict, nanoseconds
+
+    void runTick() {
+        vector<StateDelta> batch;
+        {
+            lock_guard<mutex> lock(queueMutex);
+            batch.swap(queue);
         }
+        ticks++;
+        if (batch.empty()) { idleTicks++; return; }
 
-        maximum.assign(numProcesses, vector<int>(numResources, 0));
-        cout << "\nEnter Maximum Matrix (max need for each process):\n";
-        for (int i = 0; i < numProcesses; i++) {
-            cout << "Process P" << i << " (enter " << numResources << " values): ";
-            for (int j = 0; j < numResources; j++) {
-                cin >> maximum[i][j];
-                if (maximum[i][j] < 0) maximum[i][j] = 0;
+        // Runs of consecutive requests go through admitBatch (one safety pass per run)
+        bool claimsExceedTotal = false, freed = false;
+        vector<int> blocked, total;
+        vector<pair<int, vector<int>>> requests;
+        vector<AdmissionResult> results;
+        auto admitPending = [&]() {
+            if (requests.empty()) return;
+            detector.admitBatch(requests, results);
+            for (size_t k = 0; k < requests.size(); ++k) {
+                if (results[k] == AdmissionResult::NotAvailable || results[k] == AdmissionResult::Unsafe) {
+                    blocked.push_back(requests[k].first);
+                }
+            }
+            requests.clear();
+        };
+        for (const StateDelta& delta : batch) {
+            if (delta.kind == DeltaKind::Request) { requests.push_back(make_pair(delta.processId, delta.values)); continue; }
+            admitPending();
+            switch (delta.kind) {
+                case DeltaKind::Request:
+                    break;
+                case DeltaKind::Release:
+                    freed = detector.releaseResources(delta.processId, delta.values) || freed;
+                    break;
+                case DeltaKind::Arrival:
+                    // Appending a newcomer to a safe sequence keeps it safe unless its claim
+                    // exceeds the total instances (total is unchanged by grants and releases)
+                    if (detector.addProcess(delta.values) < 0) break;
+                    if (total.empty()) total = detector.totalResources();
+                    for (size_t j = 0; j < total.size(); ++j) claimsExceedTotal = claimsExceedTotal || delta.values[j] > total[j];
+                    break;
+                case DeltaKind::Exit:
+                    freed = detector.removeProcess(delta.processId) || freed;
+                    break;
             }
         }
+        admitPending();
+        deltasApplied += batch.size();
 
-        allocation.assign(numProcesses, vector<int>(numResources, 0));
-        cout << "\nEnter Allocation Matrix (currently allocated resources):\n";
-        for (int i = 0; i < numProcesses; i++) {
-            cout << "Process P" << i << " (enter " << numResources << " values): ";
-            for (int j = 0; j < numResources; j++) {
-                cin >> allocation[i][j];
-                if (allocation[i][j] < 0) allocation[i][j] = 0;
-                if (allocation[i][j] > maximum[i][j]) {
-                    cout << "Error: Allocation cannot exceed maximum for P" << i << " R" << j << "!\n";
-                    return false;
-                }
+        bool checkSafety = !deltaDriven || claimsExceedTotal || (freed && !safe);
+        bool checkDeadlock = !deltaDriven || !blocked.empty() || (freed && !deadlocked.empty());
+        auto checkStart = chrono::steady_clock::now();
+        if (checkSafety) {
+            vector<int> safeSeq;
+            safe = detector.isSnapshotSafe(safeSeq);
+            safetyChecks++;
+        }
+        if (checkDeadlock) {
+            vector<int> found;
+            if (deltaDriven) {
+                vector<bool> focus(detector.getNumProcesses(), false);
+                for (int p : blocked) if (p < (int)focus.size()) focus[p] = true;
+                for (int p : deadlocked) if (p < (int)focus.size()) focus[p] = true;
+                detector.detectDeadlockByReduction(found, &focus);
+            } else {
+                detector.detectDeadlockByReduction(found);
             }
+            if (!found.empty() && deadlocked.empty()) deadlockEvents++;
+            deadlocked.swap(found);
+            reductions++;
         }
+        if (!checkSafety && !checkDeadlock) skippedTicks++;
+        auto now = chrono::steady_clock::now();
+        checkSeconds += chrono::duration<double>(now - checkStart).count();
+        for (const StateDelta& delta : batch) {
+            detectionLatency.record((uint64_t)chrono::duration_cast<chrono::nanoseconds>(now - delta.submitted).count());
+        }
+    }
 
-        available.assign(numResources, 0);
-        for (int j = 0; j < numResources; j++) {
-            int totalAllocated = 0;
-            for (int i = 0; i < numProcesses; i++) totalAllocated += allocation[i][j];
-            available[j] = totalResources[j] - totalAllocated;
-            if (available[j] < 0) {
-                cout << "Error: Allocation exceeds total resources for R" << j << "!\n";
-                return false;
+    void monitorLoop() {
+        double cpuStart = threadCpuSeconds();
+        auto next = chrono::steady_clock::now();
+        while (running.load()) {
+            next += tickPeriod;
+            runTick();
+            this_thread::sleep_until(next);
+        }
+        runTick();  // Drain what arrived before stop()
+        cpuSeconds = threadCpuSeconds() - cpuStart;
+    }
+
+public:
+    DeadlockMonitor(DeadlockDetector& target, int tickUs, bool deltaDrivenChecks)
+        : detector(target), tickPeriod(max(1, tickUs)), deltaDriven(deltaDrivenChecks), running(false), safe(true),
+          ticks(0), idleTicks(0), skippedTicks(0), safetyChecks(0), reductions(0), deadlockEvents(0),
+          deltasApplied(0), cpuSeconds(0), checkSeconds(0) {}
+
+    ~DeadlockMonitor() { stop(); }
+
+    // Ticks only re-check what deltas can have changed, so the verdicts are seeded with one
+    // full check first: a state that is already unsafe or deadlocked is reported at once
+    void start() {
+        if (running.exchange(true)) return;
+        vector<int> safeSeq;
+        safe = detector.isSnapshotSafe(safeSeq);
+        safetyChecks++;
+        detector.detectDeadlockByReduction(deadlocked);
+        reductions++;
+        if (!deadlocked.empty()) deadlockEvents++;
+        loop = thread(&DeadlockMonitor::monitorLoop, this);
+    }
+
+    void stop() {
+        running = false;
+        if (loop.joinable()) loop.join();
+    }
+
+    // Queue a delta for the next tick (thread-safe)
+    void submit(StateDelta delta) {
+        delta.submitted = chrono::steady_clock::now();
+        lock_guard<mutex> lock(queueMutex);
+        queue.push_back(delta);
+    }
+
+    // Latest verdicts; read after stop() (they belong to the monitor thread while it runs)
+    bool isSafe() const { return safe; }
+    const vector<int>& deadlockedProcesses() const { return deadlocked; }
+
+    // Summary after stop(): tick decisions, CPU use over wallSeconds, latency against the SLO
+    string report(double wallSeconds, double sloMs) const {
+        ostringstream out;
+        out << fixed << setprecision(1);
+        out << "Ticks: " << ticks << " (" << idleTicks << " idle, " << skippedTicks << " skipped), safety checks: "
+            << safetyChecks << ", reductions: " << reductions << ", deadlock events: " << deadlockEvents << "\n";
+        out << "Deltas: " << deltasApplied << ", monitor CPU: " << 100.0 * cpuSeconds / max(wallSeconds, 1e-9)
+            << "%, of which checks: " << 100.0 * checkSeconds / max(wallSeconds, 1e-9) << "%\n";
+        out << setprecision(3);
+        double p50 = detectionLatency.quantile(0.5) / 1e6, p99 = detectionLatency.quantile(0.99) / 1e6;
+        double worst = detectionLatency.maxValue.load() / 1e6;
+        out << "Detection latency: p50 " << p50 << " ms, p99 " << p99 << " ms, max " << worst << " ms (SLO "
+            << sloMs << " ms: " << (p99 <= sloMs ? "met" : "MISSED") << ")\n";
+        out << "Currently " << (safe ? "safe" : "unsafe") << ", " << deadlocked.size() << " processes deadlocked\n";
+        return out.str();
+    }
+};
+
+// Feed a monitor with a synthetic delta stream at the given rate for a while: single-unit
+// requests and releases, plus arrivals and exits that keep the process count stable
+void runMonitorStream(DeadlockMonitor& monitor, int processes, int resources, int rate, double seconds, mt19937& rng) {
+    const int slicesPerSecond = 1000;
+    auto start = chrono::steady_clock::now();
+    long long sent = 0;
+    for (int slice = 1; slice <= (int)(seconds * slicesPerSecond); ++slice) {
+        long long due = (long long)rate * slice / slicesPerSecond;
+        for (; sent < due; ++sent) {
+            StateDelta delta;
+            unsigned pick = rng() % 10;
+            delta.processId = (int)(rng() % processes);
+            if (pick < 8) {
+                delta.kind = pick < 4 ? DeltaKind::Request : DeltaKind::Release;
+                delta.values.assign(resources, 0);
+                delta.values[rng() % resources] = 1;
+            } else if (pick == 8) {
+                delta.kind = DeltaKind::Arrival;
+                delta.values.assign(resources, 0);
+                for (int& v : delta.values) v = 1 + (int)(rng() % 2);
+            } else {
+                delta.kind = DeltaKind::Exit;
             }
+            monitor.submit(delta);
         }
+        this_thread::sleep_until(start + chrono::microseconds(1000000LL * slice / slicesPerSecond));
+    }
+}
 
-        calculateNeed();
-        cout << "\n[SUCCESS] Data entered successfully!\n";
-        return true;
+// Run the delta-driven monitor and the check-everything baseline at increasing delta rates.
+// Resources are scarce (a few free instances each), so some requests have to wait.
+void runMonitorBenchmark(int processes, int resources, double seconds, int tickUs, double sloMs) {
+    mt19937 stateRng(42u);
+    vector<vector<int>> maximum(processes, vector<int>(resources, 2));
+    vector<vector<int>> allocation(processes, vector<int>(resources, 0));
+    for (auto& row : allocation) for (int& a : row) a = (int)(stateRng() % 2);
+    vector<int> available(resources, 4);
+
+    cout << "\n========== CONTINUOUS MONITORING ==========\n";
+    cout << "Processes: " << processes << ", Resources: " << resources << ", Tick: " << tickUs
+         << " us, " << seconds << " s per run\n";
+    const int rates[] = { 10000, 50000, 200000 };
+    for (int rate : rates) {
+        for (int driven = 1; driven >= 0; --driven) {
+            DeadlockDetector detector;
+            detector.loadState(available, maximum, allocation);
+            DeadlockMonitor monitor(detector, tickUs, driven == 1);
+            mt19937 rng(99u);
+            cout << "\n--- " << rate << " deltas/s, " << (driven ? "delta-driven" : "full re-check every tick") << " ---\n";
+            auto start = chrono::steady_clock::now();
+            monitor.start();
+            runMonitorStream(monitor, processes, resources, rate, seconds, rng);
+            monitor.stop();
+            cout << monitor.report(chrono::duration<double>(chrono::steady_clock::now() - start).count(), sloMs);
+        }
     }
+}
 
-    // Generate random system state for testing
-    bool generateRandomInput() {
-        cout << "\n========== RANDOM INPUT GENERATION ==========\n";
+// ---------------------------------------------------------------------------------------
+// Differential fuzzing: every engine is checked against brute-force oracles on small random
+// and adversarial states. The oracles are deliberately naive and share no code with the
+// engines they check.
+// ---------------------------------------------------------------------------------------
 
-        cout << "Enter number of processes (or 0 for random 3-7): ";
-        int p; cin >> p;
-        if (p == 0) numProcesses = 3 + rand() % 5;
-        else numProcesses = p;
+// A small state to test: need is derived as max(0, maximum - allocation)
+struct FuzzCase {
+    string kind;
+    vector<int> available;
+    vector<vector<int>> maximum, allocation, need, request;
+};
 
-        cout << "Enter number of resources (or 0 for random 3-5): ";
-        int r; cin >> r;
-        if (r == 0) numResources = 3 + rand() % 3;
-        else numResources = r;
+// Exhaustive search over finished-process sets: is there any order in which everyone finishes?
+// Terminated processes count as finished but return nothing.
+bool bruteForceSafe(const vector<int>& available, const vector<vector<int>>& allocation,
+                    const vector<vector<int>>& need, const vector<bool>* terminated = nullptr) {
+    int n = (int)allocation.size(), m = (int)available.size();
+    unsigned start = 0;
+    if (terminated != nullptr) for (int i = 0; i < n; ++i) if ((*terminated)[i]) start |= 1u << i;
+    vector<char> dead(1u << n, 0);  // Finished sets already shown to lead nowhere
+    function<bool(unsigned)> search = [&](unsigned done) -> bool {
+        if (done == (1u << n) - 1) return true;
+        if (dead[done]) return false;
+        vector<int> work = available;
+        for (int i = 0; i < n; ++i) {
+            if ((done >> i & 1) && !((start >> i) & 1)) for (int j = 0; j < m; ++j) work[j] += allocation[i][j];
+        }
+        for (int i = 0; i < n; ++i) {
+            if (done >> i & 1) continue;
+            bool fits = true;
+            for (int j = 0; j < m; ++j) if (need[i][j] > work[j]) fits = false;
+            if (fits && search(done | (1u << i))) return true;
+        }
+        dead[done] = 1;
+        return false;
+    };
+    return search(start);
+}
+
+// Replay a claimed safe sequence step by step
+bool sequenceIsSafe(const vector<int>& available, const vector<vector<int>>& allocation,
+                    const vector<vector<int>>& need, const vector<int>& sequence, const vector<bool>* terminated = nullptr) {
+    int n = (int)allocation.size(), m = (int)available.size();
+    vector<bool> seen(n, false);
+    int expected = 0;
+    for (int i = 0; i < n; ++i) if (terminated == nullptr || !(*terminated)[i]) expected++;
+    if ((int)sequence.size() != expected) return false;
+    vector<int> work = available;
+    for (int i : sequence) {
+        if (i < 0 || i >= n || seen[i] || (terminated != nullptr && (*terminated)[i])) return false;
+        seen[i] = true;
+        for (int j = 0; j < m; ++j) if (need[i][j] > work[j]) return false;
+        for (int j = 0; j < m; ++j) work[j] += allocation[i][j];
+    }
+    return true;
+}
+
+// Repeated sweeps over the request matrix until nothing changes; returns the stuck processes
+vector<int> bruteForceDeadlocked(const vector<int>& available, const vector<vector<int>>& allocation,
+                                 const vector<vector<int>>& request) {
+    int n = (int)allocation.size(), m = (int)available.size();
+    vector<int> work = available, stuck;
+    vector<bool> done(n, false);
+    for (bool progress = true; progress;) {
+        progress = false;
+        for (int i = 0; i < n; ++i) {
+            if (done[i]) continue;
+            bool fits = true;
+            for (int j = 0; j < m; ++j) if (request[i][j] > work[j]) fits = false;
+            if (!fits) continue;
+            for (int j = 0; j < m; ++j) work[j] += allocation[i][j];
+            done[i] = progress = true;
+        }
+    }
+    for (int i = 0; i < n; ++i) if (!done[i]) stuck.push_back(i);
+    return stuck;
+}
+
+// Can v reach itself in the graph (adjacency matrix)?
+bool bruteForceOnCycle(const vector<vector<bool>>& graph, int v) {
+    int n = (int)graph.size();
+    vector<bool> seen(n, false);
+    vector<int> frontier(1, v);
+    while (!frontier.empty()) {
+        int u = frontier.back();
+        frontier.pop_back();
+        for (int w = 0; w < n; ++w) {
+            if (!graph[u][w]) continue;
+            if (w == v) return true;
+            if (!seen[w]) { seen[w] = true; frontier.push_back(w); }
+        }
+    }
+    return false;
+}
+
+// Independent model of request validation and admission (mirrors the documented rules)
+AdmissionResult expectedAdmission(const vector<int>& available, const vector<vector<int>>& allocation,
+                                  const vector<vector<int>>& need, int processId, const vector<int>& requestVec) {
+    int n = (int)allocation.size(), m = (int)available.size();
+    if (processId < 0 || processId >= n) return AdmissionResult::InvalidProcess;
+    if ((int)requestVec.size() != m) return AdmissionResult::LengthMismatch;
+    for (int j = 0; j < m; ++j) if (requestVec[j] < 0 || requestVec[j] > need[processId][j]) return AdmissionResult::ExceedsNeed;
+    for (int j = 0; j < m; ++j) if (requestVec[j] > available[j]) return AdmissionResult::NotAvailable;
+    vector<int> after = available;
+    vector<vector<int>> alloc = allocation, rest = need;
+    for (int j = 0; j < m; ++j) { after[j] -= requestVec[j]; alloc[processId][j] += requestVec[j]; rest[processId][j] -= requestVec[j]; }
+    return bruteForceSafe(after, alloc, rest) ? AdmissionResult::Granted : AdmissionResult::Unsafe;
+}
+
+FuzzCase generateFuzzCase(mt19937& rng) {
+    FuzzCase c;
+    int n = 1 + (int)(rng() % 6), m = 1 + (int)(rng() % 3);
+    int shape = (int)(rng() % 8);
+    vector<int> total(m);
+    for (int& t : total) t = (int)(rng() % 7);
+    c.maximum.assign(n, vector<int>(m, 0));
+    c.allocation.assign(n, vector<int>(m, 0));
+    c.request.assign(n, vector<int>(m, 0));
+    vector<int> left = total;
+    for (int i = 0; i < n; ++i) {
+        for (int j = 0; j < m; ++j) {
+            c.allocation[i][j] = left[j] > 0 ? (int)(rng() % (left[j] + 1)) : 0;
+            left[j] -= c.allocation[i][j];
+            c.maximum[i][j] = c.allocation[i][j] + (int)(rng() % 4);
+        }
+    }
+    c.available = left;
+    c.kind = "random";
+    if (shape == 0) {                        // Some claim exceeds every instance in the system
+        c.kind = "claim_exceeds_total";
+        c.maximum[rng() % n][rng() % m] += 10;
+    } else if (shape == 1) {                 // Nothing free at all
+        c.kind = "nothing_available";
+        for (int j = 0; j < m; ++j) { c.allocation[0][j] += c.available[j]; c.maximum[0][j] += c.available[j]; c.available[j] = 0; }
+    } else if (shape == 2) {                 // Chain: only the last process can go first
+        c.kind = "chain";
+        for (int i = 0; i < n; ++i) {
+            c.allocation[i].assign(m, 0);
+            c.maximum[i].assign(m, 0);
+            c.allocation[i][0] = 1;
+            c.maximum[i][0] = n - i + 1;
+        }
+        c.available.assign(m, 0);
+        c.available[0] = 1;
+    } else if (shape == 3) {                 // Idle processes with no claims
+        c.kind = "zero_rows";
+        for (int i = 0; i < n; i += 2) {
+            for (int j = 0; j < m; ++j) { c.available[j] += c.allocation[i][j]; c.allocation[i][j] = c.maximum[i][j] = 0; }
+        }
+    }
+    c.need.assign(n, vector<int>(m, 0));
+    for (int i = 0; i < n; ++i) {
+        for (int j = 0; j < m; ++j) c.need[i][j] = max(0, c.maximum[i][j] - c.allocation[i][j]);
+    }
+    for (int i = 0; i < n; ++i) {
+        if (rng() % 2) continue;
+        for (int j = 0; j < m; ++j) c.request[i][j] = (int)(rng() % (c.need[i][j] + 2));  // May exceed need
+    }
+    return c;
+}
+
+// Random request vector, sometimes malformed
+vector<int> randomFuzzRequest(mt19937& rng, int m) {
+    int len = rng() % 10 == 0 ? m + 1 : m;
+    vector<int> v(len);
+    for (int& x : v) x = (int)(rng() % 4) - (rng() % 12 == 0 ? 2 : 0);
+    return v;
+}
+
+class FuzzHarness {
+private:
+    struct EngineTiming { long long calls; double seconds; long long failures; };
+    map<string, EngineTiming> engines;
+    mt19937 rng;
+    long long failures;
+    string scratch;                          // Directory for file-based checks
+
+    // Charges the wall time of one engine call to its row in the timing table
+    struct EngineClock {
+        EngineTiming& row;
+        chrono::steady_clock::time_point start;
+        explicit EngineClock(EngineTiming& t) : row(t), start(chrono::steady_clock::now()) { row.calls++; }
+        ~EngineClock() { row.seconds += chrono::duration<double>(chrono::steady_clock::now() - start).count(); }
+    };
+
+    template <typename Fn>
+    auto timed(const string& engine, Fn fn) -> decltype(fn()) {
+        EngineClock clock(engines[engine]);
+        return fn();
+    }
 
-        if (numProcesses <= 0 || numResources <= 0) {
-            cout << "Invalid input!\n";
-            return false;
+    void fail(const string& engine, const FuzzCase& c, const string& what) {
+        engines[engine].failures++;
+        if (++failures > 20) return;         // Enough detail for a report
+        cout << "[MISMATCH] " << engine << " on " << c.kind << " state: " << what << "\n";
+        cout << "  available:";
+        for (int v : c.available) cout << " " << v;
+        cout << "\n";
+        for (size_t i = 0; i < c.allocation.size(); ++i) {
+            cout << "  P" << i << " alloc";
+            for (int v : c.allocation[i]) cout << " " << v;
+            cout << " | max";
+            for (int v : c.maximum[i]) cout << " " << v;
+            cout << " | req";
+            for (int v : c.request[i]) cout << " " << v;
+            cout << "\n";
         }
+    }
 
-        cout << "\nGenerating random data...\n";
-        cout << "Processes: " << numProcesses << "\n";
-        cout << "Resources: " << numResources << "\n";
-
-        vector<int> totalResources(numResources);
-        for (int j = 0; j < numResources; j++) totalResources[j] = 5 + rand() % 11;
+    static void load(DeadlockDetector& detector, const FuzzCase& c) {
+        detector.loadState(c.available, c.maximum, c.allocation, &c.request);
+    }
 
-        maximum.assign(numProcesses, vector<int>(numResources, 0));
-        for (int i = 0; i < numProcesses; i++) {
-            for (int j = 0; j < numResources; j++) {
-                int half = max(1, totalResources[j] / 2);
-                maximum[i][j] = 1 + rand() % (half + 1);
+    // Snapshot invariants every engine must preserve: shapes, need = max - allocation (or 0
+    // after termination/preemption), conserved totals and a fingerprint that matches a rehash
+    bool consistent(const DeadlockDetector& detector, const vector<int>* totals, string& why) {
+        shared_ptr<const StateSnapshot> s = detector.snapshot();
+        int n = s->numProcesses, m = s->numResources;
+        if ((int)s->available.size() != m || (int)s->maximum.size() != n || (int)s->allocation.size() != n ||
+            (int)s->need.size() != n || (int)s->request.size() != n) { why = "matrix shapes"; return false; }
+        vector<int> sum = s->available;
+        for (int i = 0; i < n; ++i) {
+            if ((int)s->maximum[i].size() != m || (int)s->allocation[i].size() != m || (int)s->need[i].size() != m ||
+                (int)s->request[i].size() != m) { why = "row shapes"; return false; }
+            for (int j = 0; j < m; ++j) {
+                if (s->need[i][j] < 0 || s->allocation[i][j] < 0) { why = "negative cell"; return false; }
+                if (s->need[i][j] != 0 && s->need[i][j] != max(0, s->maximum[i][j] - s->allocation[i][j])) { why = "need"; return false; }
+                sum[j] += s->allocation[i][j];
             }
         }
+        if (totals != nullptr && sum != *totals) { why = "resources not conserved"; return false; }
+        StateHash full = hashState(s->available, s->allocation, s->need);
+        if (!(full == s->hash)) { why = "incremental hash differs from rehash"; return false; }
+        return true;
+    }
 
-        allocation.assign(numProcesses, vector<int>(numResources, 0));
-        vector<int> totalAllocated(numResources, 0);
-        for (int i = 0; i < numProcesses; i++) {
-            for (int j = 0; j < numResources; j++) {
-                int maxAlloc = min(maximum[i][j], totalResources[j] - totalAllocated[j]);
-                if (maxAlloc < 0) maxAlloc = 0;
-                allocation[i][j] = (maxAlloc == 0) ? 0 : rand() % (maxAlloc + 1);
-                totalAllocated[j] += allocation[i][j];
+    // Largest k such that granting k * direction to pid fits its need and what is available and
+    // leaves a safe state: every k is tried, so a gap in safety would show up as a mismatch
+    static int bruteForceMaxGrant(const FuzzCase& c, int pid, const vector<int>& direction) {
+        int bound = INT_MAX;
+        for (size_t j = 0; j < direction.size(); ++j) {
+            if (direction[j] > 0) bound = min(bound, min(c.need[pid][j], c.available[j]) / direction[j]);
+        }
+        if (bound == INT_MAX) return 0;
+        int best = 0;
+        for (int k = 1; k <= bound; ++k) {
+            vector<int> av = c.available;
+            vector<vector<int>> al = c.allocation, ne = c.need;
+            for (size_t j = 0; j < direction.size(); ++j) {
+                av[j] -= k * direction[j]; al[pid][j] += k * direction[j]; ne[pid][j] -= k * direction[j];
             }
+            if (bruteForceSafe(av, al, ne)) best = k;
         }
+        return best;
+    }
 
-        available.assign(numResources, 0);
-        for (int j = 0; j < numResources; j++) available[j] = totalResources[j] - totalAllocated[j];
-
-        calculateNeed();
-        cout << "\n[SUCCESS] Random data generated successfully!\n";
-        return true;
+    static vector<int> totalsOf(const FuzzCase& c) {
+        vector<int> sum = c.available;
+        for (const vector<int>& row : c.allocation) for (size_t j = 0; j < row.size(); ++j) sum[j] += row[j];
+        return sum;
     }
 
-    // Display current system state (all matrices)
-    void displayState() {
-        cout << "\n========== CURRENT SYSTEM STATE ==========\n";
+    void checkSafetyEngines(const FuzzCase& c) {
+        int n = (int)c.allocation.size();
+        bool oracle = timed("brute_force_safety", [&]() { return bruteForceSafe(c.available, c.allocation, c.need); });
 
-        cout << "\nAvailable Resources: ";
-        for (int i = 0; i < numResources; i++) {
-            cout << "R" << i << ":" << available[i] << " ";
+        vector<int> seq;
+        bool reference = timed("computeSafeSequence", [&]() { return computeSafeSequence(c.available, c.allocation, c.need, seq); });
+        if (reference != oracle) fail("computeSafeSequence", c, "verdict differs from brute force");
+        if (reference && !sequenceIsSafe(c.available, c.allocation, c.need, seq)) fail("computeSafeSequence", c, "invalid safe sequence");
+
+        if (reference) {
+            bool verified = timed("verifySafeSequence", [&]() { return verifySafeSequence(c.available, c.allocation, c.need, seq); });
+            if (!verified) fail("verifySafeSequence", c, "rejects a valid sequence");
         }
-        cout << "\n";
+        vector<int> order(n);
+        for (int i = 0; i < n; ++i) order[i] = i;
+        shuffle(order.begin(), order.end(), rng);
+        bool replay = timed("verifySafeSequence", [&]() { return verifySafeSequence(c.available, c.allocation, c.need, order); });
+        if (replay != sequenceIsSafe(c.available, c.allocation, c.need, order)) fail("verifySafeSequence", c, "wrong verdict on a permutation");
 
-        cout << "\nAllocation Matrix:\n     ";
-        for (int j = 0; j < numResources; j++) cout << "R" << j << "  ";
-        cout << "\n";
-        for (int i = 0; i < numProcesses; i++) {
-            cout << "P" << i << ": ";
-            for (int j = 0; j < numResources; j++) cout << setw(3) << allocation[i][j] << " ";
-            cout << "\n";
+        DeadlockDetector detector;
+        load(detector, c);
+        ostringstream sink;
+        streambuf* saved = cout.rdbuf(sink.rdbuf());
+        bool interactive = timed("bankersAlgorithmDetection", [&]() { return detector.bankersAlgorithmDetection(seq); });
+        cout.rdbuf(saved);
+        if (interactive != oracle) fail("bankersAlgorithmDetection", c, "verdict differs from brute force");
+
+        vector<bool> terminated(n, false);
+        for (int i = 0; i < n; ++i) terminated[i] = rng() % 3 == 0;
+        bool partial = timed("bankersAlgorithmCompute", [&]() { return detector.bankersAlgorithmCompute(seq, &terminated); });
+        if (partial != bruteForceSafe(c.available, c.allocation, c.need, &terminated)) {
+            fail("bankersAlgorithmCompute", c, "verdict with terminated processes differs");
+        } else if (partial && !sequenceIsSafe(c.available, c.allocation, c.need, seq, &terminated)) {
+            fail("bankersAlgorithmCompute", c, "invalid sequence with terminated processes");
         }
 
-        cout << "\nMaximum Matrix:\n     ";
-        for (int j = 0; j < numResources; j++) cout << "R" << j << "  ";
-        cout << "\n";
-        for (int i = 0; i < numProcesses; i++) {
-            cout << "P" << i << ": ";
-            for (int j = 0; j < numResources; j++) cout << setw(3) << maximum[i][j] << " ";
-            cout << "\n";
+        detector.enableVerdictCache(8);
+        for (int round = 0; round < 2; ++round) {     // Miss, then hit
+            bool cached = timed("verdict_cache", [&]() { return detector.isSnapshotSafe(seq); });
+            if (cached != oracle) fail("verdict_cache", c, round ? "cached verdict differs" : "verdict differs");
+            else if (cached && !sequenceIsSafe(c.available, c.allocation, c.need, seq)) fail("verdict_cache", c, "invalid cached sequence");
         }
 
-        cout << "\nNeed Matrix:\n     ";
-        for (int j = 0; j < numResources; j++) cout << "R" << j << "  ";
-        cout << "\n";
-        for (int i = 0; i < numProcesses; i++) {
-            cout << "P" << i << ": ";
-            for (int j = 0; j < numResources; j++) cout << setw(3) << need[i][j] << " ";
-            cout << "\n";
+        // Grant overlay: check a hypothetical grant without copying matrices
+        int pid = (int)(rng() % n);
+        vector<int> grant(c.available.size());
+        for (size_t j = 0; j < grant.size(); ++j) grant[j] = (int)(rng() % (min(c.need[pid][j], c.available[j]) + 1));
+        vector<int> after = c.available;
+        vector<vector<int>> alloc = c.allocation, rest = c.need;
+        for (size_t j = 0; j < grant.size(); ++j) { after[j] -= grant[j]; alloc[pid][j] += grant[j]; rest[pid][j] -= grant[j]; }
+        bool overlay = timed("grant_overlay", [&]() { return computeSafeSequence(c.available, c.allocation, c.need, seq, nullptr, pid, &grant); });
+        if (overlay != bruteForceSafe(after, alloc, rest)) fail("grant_overlay", c, "verdict differs from applying the grant");
+        if (overlay) {
+            bool verified = timed("verifySafeSequence", [&]() { return verifySafeSequence(c.available, c.allocation, c.need, seq, pid, &grant); });
+            if (!verified) fail("verifySafeSequence", c, "rejects a valid sequence under a grant overlay");
         }
-        cout << "==========================================\n";
-    }
+        shuffle(order.begin(), order.end(), rng);
+        replay = timed("verifySafeSequence", [&]() { return verifySafeSequence(c.available, c.allocation, c.need, order, pid, &grant); });
+        if (replay != sequenceIsSafe(after, alloc, rest, order)) fail("verifySafeSequence", c, "wrong verdict on a permutation under a grant overlay");
 
-    // Banker's Algorithm: Check for safe state and find safe sequence
-    bool bankersAlgorithmDetection(vector<int>& safeSequence, const vector<bool>* terminatedProcesses = nullptr) {
-        vector<int> work = available;           // Work vector (copy of available)
-        vector<bool> finish(numProcesses, false);  // Process completion flags
-        safeSequence.clear();                   // Clear previous sequence
+        // Max-safe-grant queries against the largest safe k found by brute force
+        int r = (int)(rng() % c.available.size());
+        vector<int> unit(c.available.size(), 0);
+        unit[r] = 1;
+        int answer = timed("maxSafeGrant", [&]() { return detector.maxSafeGrant(pid, r); });
+        int expected = bruteForceMaxGrant(c, pid, unit);
+        if (answer != expected) fail("maxSafeGrant", c, "returned " + to_string(answer) + ", brute force " + to_string(expected));
 
-        if (terminatedProcesses != nullptr) {
-            for (int i = 0; i < numProcesses; i++) {
-                if ((*terminatedProcesses)[i]) {
-                    finish[i] = true;
-                }
-            }
+        vector<int> direction(c.available.size());
+        for (int probe = 0; probe < 3; ++probe) {
+            for (int& d : direction) d = (int)(rng() % 3);
+            answer = timed("maxSafeGrantAlong", [&]() { return detector.maxSafeGrantAlong(pid, direction); });
+            expected = bruteForceMaxGrant(c, pid, direction);
+            if (answer != expected) fail("maxSafeGrantAlong", c, "returned " + to_string(answer) + ", brute force " + to_string(expected));
         }
 
-        int activeProcesses = numProcesses;
-        if (terminatedProcesses != nullptr) {
-            for (int i = 0; i < numProcesses; i++) {
-                if ((*terminatedProcesses)[i]) activeProcesses--;
+        int threads = 1 + (int)(rng() % 3);
+        vector<vector<int>> table = timed("maxSafeGrantAll", [&]() { return detector.maxSafeGrantAll(threads); });
+        for (int i = 0; i < n && table.size() == (size_t)n; ++i) {
+            for (size_t j = 0; j < unit.size(); ++j) {
+                unit.assign(unit.size(), 0);
+                unit[j] = 1;
+                expected = bruteForceMaxGrant(c, i, unit);
+                if (table[i][j] != expected) {
+                    fail("maxSafeGrantAll", c, "P" + to_string(i) + " R" + to_string(j) + ": returned " + to_string(table[i][j]) +
+                         ", brute force " + to_string(expected));
+                }
             }
         }
+        if (table.size() != (size_t)n) fail("maxSafeGrantAll", c, "table has the wrong number of rows");
+    }
 
-        int count = 0;
-        while (count < activeProcesses) {
-            bool found = false;
-            for (int i = 0; i < numProcesses; i++) {
-                if (!finish[i]) {
-                    bool canFinish = true;
-                    for (int j = 0; j < numResources; j++) {
-                        if (need[i][j] > work[j]) { canFinish = false; break; }
-                    }
-                    if (canFinish) {
-                        for (int j = 0; j < numResources; j++) work[j] += allocation[i][j];
-                        safeSequence.push_back(i);
-                        finish[i] = true;
-                        found = true;
-                        count++;
+    void checkAdmissionEngines(const FuzzCase& c) {
+        int n = (int)c.allocation.size(), m = (int)c.available.size();
+        vector<int> totals = totalsOf(c);
+        string why;
+
+        // Single requests: quiet optimistic path, the interactive path, and a cached detector
+        for (int variant = 0; variant < 3; ++variant) {
+            DeadlockDetector detector;
+            load(detector, c);
+            if (variant == 2) detector.enableVerdictCache(16);
+            for (int step = 0; step < 4; ++step) {
+                shared_ptr<const StateSnapshot> s = detector.snapshot();
+                int pid = (int)(rng() % (n + 1)) - (rng() % 8 == 0 ? 1 : 0);
+                vector<int> req = randomFuzzRequest(rng, m);
+                AdmissionResult expected = expectedAdmission(s->available, s->allocation, s->need, pid, req);
+                string engine = variant == 1 ? "requestResources" : variant == 2 ? "admitRequest+cache" : "admitRequest";
+                if (variant == 1) {
+                    vector<int> copy = req;
+                    ostringstream sink;
+                    streambuf* saved = cout.rdbuf(sink.rdbuf());
+                    bool granted = timed(engine, [&]() { return detector.requestResources(pid, copy); });
+                    cout.rdbuf(saved);
+                    if (granted != (expected == AdmissionResult::Granted)) {
+                        fail(engine, c, string("P") + to_string(pid) + (granted ? " granted" : " denied") + ", expected " + admissionResultName(expected));
                     }
-                }
-            }
-            if (!found) {
-                cout << "\n[DEADLOCK DETECTED] System is in unsafe state!\n";
-                cout << "Processes that cannot finish: ";
-                for (int i = 0; i < numProcesses; ++i) {
-                    if (!finish[i] && (terminatedProcesses == nullptr || !(*terminatedProcesses)[i])) {
-                        cout << "P" << i << " ";
+                } else {
+                    AdmissionResult got = timed(engine, [&]() { return detector.admitRequest(pid, req); });
+                    if (got != expected) {
+                        fail(engine, c, string("P") + to_string(pid) + " got " + admissionResultName(got) + ", expected " + admissionResultName(expected));
                     }
                 }
-                cout << "\n";
-                return false;
+                if (!consistent(detector, &totals, why)) fail(engine, c, why);
+                if (expected == AdmissionResult::Granted && rng() % 2) detector.releaseResources(pid, req);
             }
         }
 
-        cout << "\n[SAFE STATE] No deadlock detected.";
-        if (!safeSequence.empty()) {
-            cout << "\nSafe sequence: ";
-            for (int i : safeSequence) cout << "P" << i << " ";
-        } else {
-            cout << "\nAll processes have been terminated.";
+        // Batches: model the documented rule (all valid granted if the combined state is
+        // safe, otherwise each request checked in order)
+        DeadlockDetector detector;
+        load(detector, c);
+        vector<pair<int, vector<int>>> batch;
+        int size = 1 + (int)(rng() % 4);
+        for (int k = 0; k < size; ++k) batch.push_back(make_pair((int)(rng() % n), randomFuzzRequest(rng, m)));
+        vector<AdmissionResult> results, expected(batch.size());
+        vector<int> av = c.available;
+        vector<vector<int>> al = c.allocation, ne = c.need;
+        for (size_t k = 0; k < batch.size(); ++k) {
+            expected[k] = expectedAdmission(av, al, ne, batch[k].first, batch[k].second);
+            if (expected[k] == AdmissionResult::Unsafe) expected[k] = AdmissionResult::Granted;  // Safety judged jointly
+            if (expected[k] != AdmissionResult::Granted) continue;
+            for (int j = 0; j < m; ++j) {
+                av[j] -= batch[k].second[j]; al[batch[k].first][j] += batch[k].second[j]; ne[batch[k].first][j] -= batch[k].second[j];
+            }
         }
-        cout << "\n";
-        return true;
-    }
-
-    bool bankersAlgorithmCompute(vector<int>& safeSequence, const vector<bool>* terminatedProcesses = nullptr) {
-        vector<int> work = available;
-        vector<bool> finish(numProcesses, false);
-        safeSequence.clear();
-        if (terminatedProcesses != nullptr) {
-            for (int i = 0; i < numProcesses; ++i) if ((*terminatedProcesses)[i]) finish[i] = true;
-        }
-        int active = numProcesses;
-        if (terminatedProcesses != nullptr) for (int i = 0; i < numProcesses; ++i) if ((*terminatedProcesses)[i]) active--;
-        int count = 0;
-        while (count < active) {
-            bool found = false;
-            for (int i = 0; i < numProcesses; ++i) if (!finish[i]) {
-                bool canFinish = true;
-                for (int j = 0; j < numResources; ++j) if (need[i][j] > work[j]) { canFinish = false; break; }
-                if (canFinish) {
-                    for (int j = 0; j < numResources; ++j) work[j] += allocation[i][j];
-                    finish[i] = true; safeSequence.push_back(i); found = true; count++;
+        if (!bruteForceSafe(av, al, ne)) {
+            av = c.available; al = c.allocation; ne = c.need;
+            for (size_t k = 0; k < batch.size(); ++k) {
+                expected[k] = expectedAdmission(av, al, ne, batch[k].first, batch[k].second);
+                if (expected[k] != AdmissionResult::Granted) continue;
+                for (int j = 0; j < m; ++j) {
+                    av[j] -= batch[k].second[j]; al[batch[k].first][j] += batch[k].second[j]; ne[batch[k].first][j] -= batch[k].second[j];
                 }
             }
-            if (!found) return false; // unsafe
         }
-        return true;
+        timed("admitBatch", [&]() { detector.admitBatch(batch, results); });
+        if (results != expected) fail("admitBatch", c, "batch results differ from the model");
+        if (!consistent(detector, &totals, why)) fail("admitBatch", c, why);
+
+        // Recovery keeps totals and need consistent
+        for (int strategy = 0; strategy < 2; ++strategy) {
+            DeadlockDetector victim;
+            load(victim, c);
+            ostringstream sink;
+            streambuf* saved = cout.rdbuf(sink.rdbuf());
+            timed("recovery", [&]() {
+                if (strategy == 0) victim.processTermination(true); else victim.resourcePreemption(true);
+            });
+            cout.rdbuf(saved);
+            if (!consistent(victim, &totals, why)) fail("recovery", c, why);
+        }
     }
 
-    // Wait-For Graph: Detect deadlock using graph cycle detection
-    bool waitForGraphDetection() {
-        cout << "\n========== WAIT-FOR GRAPH DETECTION ==========" << "\n";
+    void checkGraphEngines(const FuzzCase& c) {
+        int n = (int)c.allocation.size(), m = (int)c.available.size();
+        DeadlockDetector detector;
+        load(detector, c);
 
-        vector<vector<bool>> waitForGraph(numProcesses, vector<bool>(numProcesses, false));
-        vector<bool> blocked(numProcesses, false);
+        vector<int> oracle = timed("brute_force_reduction", [&]() { return bruteForceDeadlocked(c.available, c.allocation, c.request); });
+        vector<int> found;
+        timed("graph_reduction", [&]() { return detector.detectDeadlockByReduction(found); });
+        if (found != oracle) fail("graph_reduction", c, "deadlocked set differs from repeated sweeps");
 
-        for (int i = 0; i < numProcesses; ++i) {
-            bool isBlocked = false;
-            for (int j = 0; j < numResources; ++j) {
-                if (need[i][j] > available[j]) { isBlocked = true; break; }
-            }
-            blocked[i] = isBlocked;
-            if (!isBlocked) continue;
+        vector<bool> focus(n, false);
+        for (int i = 0; i < n; ++i) focus[i] = rng() % 3 == 0;
+        bool clear = timed("focused_reduction", [&]() { return detector.detectDeadlockByReduction(found, &focus); });
+        bool focusStuck = false;
+        for (int p : oracle) focusStuck = focusStuck || focus[p];
+        if (clear ? focusStuck : found != oracle) fail("focused_reduction", c, "disagrees with repeated sweeps");
 
-            for (int j = 0; j < numResources; ++j) {
-                if (need[i][j] > available[j]) {
-                    for (int k = 0; k < numProcesses; ++k) {
-                        if (k != i && allocation[k][j] > 0) {
-                            waitForGraph[i][k] = true;
-                        }
-                    }
-                }
+        // Wait-for graph on outstanding requests, cycles by reachability
+        vector<vector<bool>> graph(n, vector<bool>(n, false));
+        for (int i = 0; i < n; ++i) {
+            for (int j = 0; j < m; ++j) {
+                if (c.request[i][j] <= c.available[j]) continue;
+                for (int h = 0; h < n; ++h) if (h != i && c.allocation[h][j] > 0) graph[i][h] = true;
             }
         }
+        vector<int> component = timed("wait_edges_scc", [&]() { return processesOnCycles(buildWaitEdges(*detector.snapshot())); });
+        for (int i = 0; i < n; ++i) {
+            if ((component[i] >= 0) != bruteForceOnCycle(graph, i)) { fail("wait_edges_scc", c, "cycle membership of P" + to_string(i)); break; }
+        }
 
-        cout << "\nProcesses currently blocked (need > available): ";
-        bool anyBlocked = false;
-        for (int i = 0; i < numProcesses; ++i) if (blocked[i]) { cout << "P" << i << " "; anyBlocked = true; }
-        if (!anyBlocked) cout << "None";
-        cout << "\n";
-
-        cout << "\nWait-For Graph (Pi waits for Pj):\n";
-        for (int i = 0; i < numProcesses; ++i) {
-            cout << "P" << i << " -> ";
-            bool anyEdge = false;
-            for (int j = 0; j < numProcesses; ++j) {
-                if (waitForGraph[i][j]) { cout << "P" << j << " "; anyEdge = true; }
+        // Interactive wait-for graph: blocked on need, deadlock if a cycle or an unsafe state
+        vector<vector<bool>> needGraph(n, vector<bool>(n, false));
+        for (int i = 0; i < n; ++i) {
+            for (int j = 0; j < m; ++j) {
+                if (c.need[i][j] <= c.available[j]) continue;
+                for (int h = 0; h < n; ++h) if (h != i && c.allocation[h][j] > 0) needGraph[i][h] = true;
             }
-            if (!anyEdge) cout << "None";
-            cout << "\n";
         }
+        bool cycle = false;
+        for (int i = 0; i < n; ++i) cycle = cycle || bruteForceOnCycle(needGraph, i);
+        bool expected = !cycle && bruteForceSafe(c.available, c.allocation, c.need);
+        ostringstream sink;
+        streambuf* saved = cout.rdbuf(sink.rdbuf());
+        bool wfg = timed("waitForGraphDetection", [&]() { return detector.waitForGraphDetection(); });
+        cout.rdbuf(saved);
+        if (wfg != expected) fail("waitForGraphDetection", c, "verdict differs from brute force");
+    }
 
-        vector<bool> visited(numProcesses, false), recStack(numProcesses, false);
-        function<bool(int)> hasCycle = [&](int v) -> bool {
-            visited[v] = true;
-            recStack[v] = true;
-            for (int u = 0; u < numProcesses; ++u) {
-                if (waitForGraph[v][u]) {
-                    if (!visited[u] && hasCycle(u)) return true;
-                    else if (recStack[u]) return true;
+    // Writers admit and release concurrently, each on its own processes, while a reader scans
+    // the published snapshots: totals stay conserved throughout, a state that started safe
+    // stays safe, and afterwards every process holds exactly what its writer was granted
+    void checkConcurrentAdmission(const FuzzCase& c) {
+        int n = (int)c.allocation.size(), m = (int)c.available.size();
+        vector<int> totals = totalsOf(c);
+        bool startedSafe = bruteForceSafe(c.available, c.allocation, c.need);
+        DeadlockDetector detector;
+        load(detector, c);
+        if (rng() % 2) detector.enableVerdictCache(16);
+        int writers = min(n, 2 + (int)(rng() % 3));
+        vector<unsigned> seeds(writers);
+        for (unsigned& seed : seeds) seed = (unsigned)rng();
+        vector<vector<int>> held = c.allocation;   // Row i is touched only by writer i % writers
+        vector<string> errors(writers + 1);        // One slot per thread; the reader's is last
+        atomic<int> running(writers), waiting(writers);
+
+        auto writer = [&](int t) {
+            mt19937 local(seeds[t]);
+            waiting.fetch_sub(1);
+            while (waiting.load() > 0) this_thread::yield();  // Start together to overlap
+
+            auto ownProcess = [&]() { return t + writers * (int)(local() % ((n - 1 - t) / writers + 1)); };
+            for (int op = 0; op < 200; ++op) {
+                int pid = ownProcess();
+                vector<int> req(m);
+                switch (local() % 4) {
+                    case 0: case 1: {
+                        for (int& x : req) x = (int)(local() % 3);
+                        if (detector.admitRequest(pid, req) == AdmissionResult::Granted) {
+                            for (int j = 0; j < m; ++j) held[pid][j] += req[j];
+                        }
+                        break;
+                    }
+                    case 2: {
+                        for (int j = 0; j < m; ++j) req[j] = (int)(local() % (held[pid][j] + 1));
+                        if (!detector.releaseResources(pid, req)) errors[t] = "valid release refused";
+                        else for (int j = 0; j < m; ++j) held[pid][j] -= req[j];
+                        break;
+                    }
+                    case 3: {
+                        vector<pair<int, vector<int>>> batch;
+                        for (int k = 0; k < 2; ++k) {
+                            for (int& x : req) x = (int)(local() % 2);
+                            batch.push_back(make_pair(k == 0 ? pid : ownProcess(), req));
+                        }
+                        vector<AdmissionResult> results;
+                        detector.admitBatch(batch, results);
+                        for (size_t k = 0; k < batch.size(); ++k) {
+                            if (results[k] != AdmissionResult::Granted) continue;
+                            for (int j = 0; j < m; ++j) held[batch[k].first][j] += batch[k].second[j];
+                        }
+                        break;
+                    }
                 }
             }
-            recStack[v] = false;
-            return false;
+            running.fetch_sub(1);
+        };
+        auto reader = [&]() {
+            vector<int> seq;
+            string why;
+            uint64_t lastVersion = 0;
+            do {
+                shared_ptr<const StateSnapshot> s = detector.snapshot();
+                if (s->version < lastVersion) { errors[writers] = "published version went backwards"; return; }
+                lastVersion = s->version;
+                if (!consistent(detector, &totals, why)) { errors[writers] = why; return; }
+                if (startedSafe && !computeSafeSequence(s->available, s->allocation, s->need, seq)) {
+                    errors[writers] = "published an unsafe state";
+                    return;
+                }
+                this_thread::yield();
+            } while (running.load() > 0);
         };
 
-        for (int i = 0; i < numProcesses; ++i) {
-            if (!visited[i] && hasCycle(i)) {
-                cout << "\nDeadlock exists.\n";
-                return false;
-            }
-        }
-
-        vector<int> safeSeq;
-        if (bankersAlgorithmCompute(safeSeq)) {
-            cout << "\nSafe sequence: ";
-            for (int p : safeSeq) cout << "P" << p << " ";
-            cout << "\n";
-            return true;
-        } else {
-            cout << "\nDeadlock exists (unsafe state without WFG cycle).\n";
-            return false;
-        }
+        timed("concurrent_admission", [&]() {
+            vector<thread> pool;
+            for (int t = 0; t < writers; ++t) pool.push_back(thread(writer, t));
+            pool.push_back(thread(reader));
+            for (thread& t : pool) t.join();
+        });
+        for (const string& error : errors) if (!error.empty()) fail("concurrent_admission", c, error);
+        string why;
+        shared_ptr<const StateSnapshot> s = detector.snapshot();
+        if (!consistent(detector, &totals, why)) fail("concurrent_admission", c, why);
+        else if (s->allocation != held) fail("concurrent_admission", c, "allocations differ from the writers' grants and releases");
     }
 
-    // Recovery strategy: Terminate processes to break deadlock
-    void processTermination(bool deadlockPreviouslyDetected) {
-        cout << "\n========== PROCESS TERMINATION RECOVERY ==========" << "\n";
-        if (!deadlockPreviouslyDetected) { cout << "No recovery needed (system safe).\n"; return; }
-        vector<bool> terminated(numProcesses, false);
-        int culprit = -1; int minAlloc = INT_MAX;
-        for (int i = 0; i < numProcesses; ++i) {
-            int totalAlloc = 0; for (int j = 0; j < numResources; ++j) totalAlloc += allocation[i][j];
-            if (totalAlloc < minAlloc && totalAlloc > 0) { minAlloc = totalAlloc; culprit = i; }
-        }
-        if (culprit == -1) { cout << "No suitable culprit to terminate.\n"; return; }
-        cout << "Terminating culprit process P" << culprit << "\n";
-        for (int j = 0; j < numResources; ++j) { available[j] += allocation[culprit][j]; allocation[culprit][j] = 0; need[culprit][j] = 0; }
-        terminated[culprit] = true;
-        vector<int> safeSeq;
-        if (bankersAlgorithmCompute(safeSeq, &terminated)) {
-            cout << "Recovered. New safe sequence: "; for (int p : safeSeq) cout << "P" << p << " "; cout << "\n";
-        } else {
-            cout << "Initial termination insufficient; escalating...\n";
-            int terminationCount = 1;
-            while (true) {
-                int minProcess = -1; int minAllocation2 = INT_MAX;
-                for (int i = 0; i < numProcesses; ++i) if (!terminated[i]) {
-                    int totalAlloc = 0; for (int j = 0; j < numResources; ++j) totalAlloc += allocation[i][j];
-                    if (totalAlloc < minAllocation2) { minAllocation2 = totalAlloc; minProcess = i; }
-                }
-                if (minProcess == -1) break;
-                cout << "Terminating additional process P" << minProcess << "\n";
-                for (int j = 0; j < numResources; ++j) { available[j] += allocation[minProcess][j]; allocation[minProcess][j] = 0; need[minProcess][j] = 0; }
-                terminated[minProcess] = true; terminationCount++;
-                if (bankersAlgorithmCompute(safeSeq, &terminated)) {
-                    cout << "Recovered after terminating " << terminationCount << " processes. Safe sequence: ";
-                    for (int p : safeSeq) cout << "P" << p << " "; cout << "\n"; return;
+    // Random mutations through every journaled path, then recovery must reproduce the state
+    void checkJournal(const FuzzCase& c) {
+        string dir = scratch + "/journal";
+        clearJournalFiles(dir);
+        StateHash expected;
+        vector<int> expectedExited;
+        int n = (int)c.allocation.size(), m = (int)c.available.size();
+        {
+            DeadlockDetector detector;
+            load(detector, c);
+            if (!detector.openJournal(dir, rng() % 2 ? JournalMode::Sync : JournalMode::Async, 4)) {
+                fail("journal_replay", c, "cannot open journal");
+                return;
+            }
+            // Idle processes (all-zero rows) are still live: only exits free a slot
+            if (detector.addProcess(vector<int>(m, 1)) != n) fail("addProcess", c, "arrival took a live process's slot");
+            for (int step = 0; step < 12; ++step) {
+                int pid = (int)(rng() % n);
+                switch (rng() % 6) {
+                    case 0: case 1: detector.admitRequest(pid, randomFuzzRequest(rng, m)); break;
+                    case 2: { vector<int> one(m, 0); one[rng() % m] = 1; detector.releaseResources(pid, one); break; }
+                    case 3: detector.addProcess(vector<int>(m, 1 + (int)(rng() % 2))); break;
+                    case 4: detector.removeProcess(pid); break;
+                    case 5: detector.setOutstandingRequest(pid, vector<int>(m, (int)(rng() % 3))); break;
                 }
+                if (step == 6) detector.checkpoint();
             }
-            cout << "Recovery failed: still unsafe after terminations.\n";
+            expected = detector.currentStateHash();
+            expectedExited = detector.exitedProcesses();
         }
+        DeadlockDetector recovered;
+        bool opened = timed("journal_replay", [&]() { return recovered.openJournal(dir); });
+        string why;
+        if (!opened || !(recovered.currentStateHash() == expected)) fail("journal_replay", c, "recovered state differs");
+        else if (recovered.exitedProcesses() != expectedExited) fail("journal_replay", c, "recovered exited slots differ");
+        else if (!consistent(recovered, nullptr, why)) fail("journal_replay", c, why);
     }
 
-    // Recovery strategy: Preempt resources from victim process
-    void resourcePreemption(bool deadlockPreviouslyDetected) {
-        cout << "\n========== RESOURCE PREEMPTION RECOVERY ==========" << "\n";
-        if (!deadlockPreviouslyDetected) { cout << "No recovery needed (system safe).\n"; return; }
-        cout << "Attempting resource preemption...\n";
-        int victim = -1; int minAlloc = INT_MAX;
-        for (int i = 0; i < numProcesses; ++i) {
-            int totalAlloc = 0; for (int j = 0; j < numResources; ++j) totalAlloc += allocation[i][j];
-            if (totalAlloc > 0 && totalAlloc < minAlloc) { minAlloc = totalAlloc; victim = i; }
-        }
-        if (victim == -1) { cout << "No suitable victim found.\n"; return; }
-        cout << "Preempting resources from P" << victim << " -> ";
-        vector<bool> preempted(numProcesses, false);
-        for (int j = 0; j < numResources; ++j) if (allocation[victim][j] > 0) {
-            cout << "R" << j << ":" << allocation[victim][j] << " ";
-            available[j] += allocation[victim][j]; allocation[victim][j] = 0; need[victim][j] = 0; preempted[victim] = true;
+    // A delta-driven monitor started on a state must report its verdicts before any delta
+    // arrives; the first call uses a fixed cross-wait deadlock
+    void checkMonitor(const FuzzCase& random, bool crossWait) {
+        FuzzCase c = random;
+        if (crossWait) {
+            c.kind = "cross_wait";
+            c.available.assign(2, 0);
+            c.allocation = { { 1, 0 }, { 0, 1 } };
+            c.maximum = { { 1, 1 }, { 1, 1 } };
+            c.need = { { 0, 1 }, { 1, 0 } };
+            c.request = { { 0, 1 }, { 1, 0 } };
         }
-        cout << "\n";
-        vector<int> safeSeq;
-        if (bankersAlgorithmCompute(safeSeq, &preempted)) {
-            cout << "Recovered. Safe sequence: "; for (int p : safeSeq) cout << "P" << p << " "; cout << "\n";
-        } else {
-            cout << "Still unsafe after preemption. Consider termination strategy.\n";
+        DeadlockDetector detector;
+        load(detector, c);
+        DeadlockMonitor monitor(detector, 1000, true);
+        timed("monitor_start", [&]() { monitor.start(); });
+        monitor.stop();
+        if (monitor.isSafe() != bruteForceSafe(c.available, c.allocation, c.need)) fail("monitor_start", c, "initial safety verdict");
+        if (monitor.deadlockedProcesses() != bruteForceDeadlocked(c.available, c.allocation, c.request)) {
+            fail("monitor_start", c, "initial deadlocked set");
         }
     }
 
-    bool requestResources(int processId, vector<int>& requestVec) {
-        cout << "\n========== BANKER'S ALGORITHM: RESOURCE REQUEST ==========\n";
-        if (processId < 0 || processId >= numProcesses) {
-            cout << "Invalid process ID!\n"; return false;
-        }
-        if ((int)requestVec.size() != numResources) {
-            cout << "Request vector length mismatch!\n"; return false;
+    // Edge chasing and central gathering over a random split must both report exactly the
+    // processes on a cycle of the global wait-for graph
+    void checkCluster() {
+        int nodes = 1 + (int)(rng() % 4), processes = 2 + (int)(rng() % 10), resources = nodes + (int)(rng() % 8);
+        SimulatedCluster cluster(nodes, processes, 0);
+        loadClusterState(cluster, processes, resources, rng);
+        vector<vector<bool>> graph(processes, vector<bool>(processes, false));
+        for (int k = 0; k < nodes; ++k) {
+            vector<vector<int>> edges = buildWaitEdges(*cluster.detectorAt(k).snapshot());
+            for (int i = 0; i < processes; ++i) for (int h : edges[i]) graph[i][h] = true;
         }
+        vector<int> expected;
+        for (int i = 0; i < processes; ++i) if (bruteForceOnCycle(graph, i)) expected.push_back(i);
 
-        cout << "Process P" << processId << " requesting: ";
-        for (int r : requestVec) cout << r << " ";
-        cout << "\n";
+        FuzzCase c;
+        c.kind = to_string(nodes) + "-node cluster";
+        ClusterRoundStats full = timed("edge_chasing", [&]() { return cluster.detectByProbes(false); });
+        ClusterRoundStats pruned = timed("edge_chasing_pruned", [&]() { return cluster.detectByProbes(true); });
+        ClusterRoundStats central = timed("central_gather", [&]() { return cluster.detectCentrally(); });
+        if (full.deadlocked != expected) fail("edge_chasing", c, "cycle members differ from brute force");
+        if (central.deadlocked != expected) fail("central_gather", c, "cycle members differ from brute force");
+        if (pruned.deadlocked.empty() != expected.empty()) fail("edge_chasing_pruned", c, "missed or invented a cycle");
+    }
 
-        for (int i = 0; i < numResources; ++i) {
-            if (requestVec[i] > need[processId][i]) {
-                cout << "[REQUEST DENIED] Request exceeds maximum need!\n"; return false;
-            }
-            if (requestVec[i] > available[i]) {
-                cout << "[REQUEST DENIED] Resources not currently available!\n"; return false;
+    // readFromFiles on well-formed and malformed inputs: it may refuse, but must never leave
+    // a state whose shapes disagree
+    void checkFiles() {
+        const string availPath = scratch + "/available.txt", maxPath = scratch + "/maximum.txt";
+        const string allocPath = scratch + "/allocation.txt", reqPath = scratch + "/request.txt";
+        for (int variant = 0; variant < 10; ++variant) {
+            int n = 1 + (int)(rng() % 4), m = 1 + (int)(rng() % 3);
+            int availR = variant == 1 ? m + 1 : variant == 2 ? m - 1 : m;
+            int allocN = variant == 3 ? n + 1 : n, allocR = variant == 4 ? m + 1 : m;
+            int maxN = variant == 8 ? -n : variant == 9 ? 0 : n;
+            ofstream avail(availPath), maxFile(maxPath), alloc(allocPath), req(reqPath);
+            avail << availR;
+            for (int j = 0; j < availR; ++j) avail << " " << rng() % 5;
+            maxFile << maxN << " " << m << "\n";
+            int maxValues = variant == 5 ? n * m - 1 : n * m;
+            for (int k = 0; k < maxValues; ++k) maxFile << 1 + rng() % 4 << " ";
+            alloc << allocN << " " << allocR << "\n";
+            int allocValues = variant == 6 ? allocN * allocR / 2 : allocN * allocR;
+            for (int k = 0; k < allocValues; ++k) alloc << rng() % 2 << " ";
+            if (variant == 7) req << n + 1 << " " << m << " 1 2";
+            else { req << n << " " << m << "\n"; for (int k = 0; k < n * m; ++k) req << rng() % 3 << " "; }
+            avail.close(); maxFile.close(); alloc.close(); req.close();
+
+            // Start from a known state so a failed load can be told apart from a partial one
+            FuzzCase before = generateFuzzCase(rng);
+            before.kind = "file variant " + to_string(variant);
+            DeadlockDetector detector;
+            load(detector, before);
+            ostringstream sink;
+            streambuf* saved = cout.rdbuf(sink.rdbuf());
+            bool loaded = timed("readFromFiles", [&]() { return detector.readFromFiles(scratch); });
+            cout.rdbuf(saved);
+            detector.setOutstandingRequest(0, vector<int>());  // Republish whatever the loader left
+            string why;
+            shared_ptr<const StateSnapshot> s = detector.snapshot();
+            if (!consistent(detector, nullptr, why)) {
+                fail("readFromFiles", before, (loaded ? "accepted file left bad state: " : "rejected file left bad state: ") + why);
+            } else if (!loaded && (s->available != before.available || s->allocation != before.allocation || s->maximum != before.maximum)) {
+                fail("readFromFiles", before, "rejected file changed the state");
+            } else if (loaded && variant >= 1 && variant <= 6) {
+                fail("readFromFiles", before, "accepted malformed files");
+            } else if (loaded && variant >= 8) {
+                fail("readFromFiles", before, "accepted non-positive dimensions");
+            } else if (!loaded && (variant == 0 || variant == 7)) {
+                fail("readFromFiles", before, "rejected well-formed files");
             }
         }
+        remove(availPath.c_str()); remove(maxPath.c_str()); remove(allocPath.c_str()); remove(reqPath.c_str());
+    }
 
-        auto oldAvailable = available;
-        auto oldAlloc = allocation[processId];
-        auto oldNeed = need[processId];
-
-        for (int i = 0; i < numResources; ++i) {
-            available[i] -= requestVec[i];
-            allocation[processId][i] += requestVec[i];
-            need[processId][i] -= requestVec[i];
-        }
+public:
+    FuzzHarness(unsigned seed, const string& scratchDir) : rng(seed), failures(0), scratch(scratchDir) {}
 
-        vector<int> safeSeq;
-        if (bankersAlgorithmDetection(safeSeq)) {
-            cout << "[REQUEST GRANTED] Resources allocated safely.\n";
-            return true;
-        } else {
-            available = oldAvailable;
-            allocation[processId] = oldAlloc;
-            need[processId] = oldNeed;
-            cout << "[REQUEST DENIED] Allocation would lead to unsafe state.\n";
-            return false;
+    long long run(int iterations) {
+        makeDirectory(scratch);
+        for (int it = 0; it < iterations; ++it) {
+            FuzzCase c = generateFuzzCase(rng);
+            checkSafetyEngines(c);
+            checkAdmissionEngines(c);
+            checkGraphEngines(c);
+            if (it % 10 == 0) checkConcurrentAdmission(c);
+            if (it % 25 == 0) checkJournal(c);
+            if (it % 50 == 0) checkCluster();
+            if (it % 50 == 0) checkMonitor(c, it == 0);
+            if (it % 100 == 0) checkFiles();
         }
+        clearJournalFiles(scratch + "/journal");
+        removeDirectory(scratch + "/journal");
+        removeDirectory(scratch);
+        return failures;
     }
 
-    void simulateResourceRequest() {
-        cout << "\n========== SIMULATE RESOURCE REQUEST ==========\n";
-        int processId;
-        cout << "Enter process ID (0-" << max(0, numProcesses - 1) << "): ";
-        cin >> processId;
-        if (processId < 0 || processId >= numProcesses) { cout << "Invalid process ID!\n"; return; }
-
-        vector<int> requestVec(numResources);
-        cout << "Enter request for " << numResources << " resources: ";
-        for (int i = 0; i < numResources; ++i) cin >> requestVec[i];
-
-        requestResources(processId, requestVec);
+    void report() const {
+        cout << "\n" << setw(26) << left << "Engine" << right << setw(10) << "Calls" << setw(12) << "Avg us"
+             << setw(10) << "Failures" << "\n";
+        for (const auto& entry : engines) {
+            const EngineTiming& t = entry.second;
+            cout << setw(26) << left << entry.first << right << setw(10) << t.calls << setw(12) << fixed << setprecision(2)
+                 << t.seconds / max(1LL, t.calls) * 1e6 << setw(10) << t.failures << "\n";
+        }
+        cout.unsetf(ios::fixed);
     }
-
-    bool isDataLoaded() const { return numProcesses > 0 && numResources > 0; }
 };
 
-// Display main menu options
-void displayMainMenu() {
-    cout << "\n========================================================\n";
-    cout << "      DEADLOCK DETECTION & RECOVERY SYSTEM           \n";
-    cout << "========================================================\n";
-    cout << "  1. Load predefined data from files                   \n";
-    cout << "  2. Enter data manually                               \n";
-    cout << "  3. Generate random data                              \n";
-    cout << "  4. Thread Deadlock Detection & Recovery              \n";
-    cout << "  0. Exit                                              \n";
-    cout << "========================================================\n";
-    cout << "Enter your choice: ";
+// Differential fuzzing entry point; returns the number of mismatches found
+long long runFuzzHarness(int iterations, unsigned seed) {
+    cout << "\n========== DIFFERENTIAL FUZZ ==========\n";
+    cout << "Iterations: " << iterations << ", Seed: " << seed << "\n";
+    FuzzHarness harness(seed, "fuzz_scratch");
+    long long failures = harness.run(iterations);
+    harness.report();
+    cout << "\n" << (failures == 0 ? "[PASS] All engines agree with the oracles.\n" : "[FAIL] Mismatches: " + to_string(failures) + "\n");
+    return failures;
 }
 
-void displayDetectionMenu1() {
-    cout << "\n========================================================\n";
-    cout << "            DEADLOCK DETECTION - PHASE 1              \n";
-    cout << "========================================================\n";
-    cout << "  1. Deadlock Detection - Banker's Algorithm           \n";
-    cout << "  2. Deadlock Detection - Wait-For Graph               \n";
-    cout << "========================================================\n";
-    cout << "Enter your choice: ";
+void printUsage(const char* program) {
+    cout << "Usage: " << program << "                      Interactive menu\n";
+    cout << "       " << program << " --bench-concurrent [threads] [processes] [resources] [ops]\n";
+    cout << "       " << program << " --bench-metrics [processes] [resources] [ops]\n";
+    cout << "       " << program << " --bench-maxgrant [processes] [resources]\n";
+    cout << "       " << program << " --bench-cache [processes] [resources] [ops] [capacity]\n";
+    cout << "       " << program << " --bench-detect [processes] [resources] [trials]\n";
+    cout << "       " << program << " --bench-journal [directory] [processes] [resources] [ops] [threads]\n";
+    cout << "       " << program << " --distributed [processes] [resources] [trials] [link-delay-us] [max-nodes]\n";
+    cout << "       " << program << " --monitor [processes] [resources] [seconds] [tick-us] [slo-ms]\n";
+    cout << "       " << program << " --fuzz [iterations] [seed]   (exit status 1 on any mismatch)\n";
+#ifdef __linux__
+    cout << "       " << program << " --serve <socket> [processes resources [journal-dir]]   (files when size is 0 or omitted)\n";
+    cout << "       " << program << " --loadgen <socket> [clients] [ops] [pipeline]\n";
+#endif
 }
 
-void displayRecoveryMenu() {
-    cout << "\n========================================================\n";
-    cout << "            DEADLOCK RECOVERY - PHASE 2               \n";
-    cout << "========================================================\n";
-    cout << "  1. Recovery Strategy - Process Termination           \n";
-    cout << "  2. Recovery Strategy - Resource Preemption           \n";
-    cout << "  0. Back to Data Menu                                 \n";
-    cout << "========================================================\n";
-    cout << "Enter your choice: ";
+// Dispatch non-interactive command line modes
+int runCommandLineMode(int argc, char* argv[]) {
+    string mode = argv[1];
+    auto intArg = [&](int index, int fallback) { return argc > index ? atoi(argv[index]) : fallback; };
+
+    if (mode == "--bench-concurrent") {
+        int hw = max(1, (int)thread::hardware_concurrency());
+        int threads = intArg(2, hw), processes = intArg(3, 64), resources = intArg(4, 8), ops = intArg(5, 20000);
+        if (threads <= 0 || processes <= 0 || resources <= 0 || ops <= 0) { printUsage(argv[0]); return 1; }
+        runConcurrentAdmissionBenchmark(threads, processes, resources, ops);
+        return 0;
+    }
+    if (mode == "--bench-metrics") {
+        int processes = intArg(2, 64), resources = intArg(3, 8), ops = intArg(4, 20000);
+        if (processes <= 0 || resources <= 0 || ops <= 0) { printUsage(argv[0]); return 1; }
+        runMetricsOverheadBenchmark(processes, resources, ops);
+        return 0;
+    }
+    if (mode == "--bench-maxgrant") {
+        int processes = intArg(2, 64), resources = intArg(3, 8);
+        if (processes <= 0 || resources <= 0) { printUsage(argv[0]); return 1; }
+        runMaxGrantBenchmark(processes, resources);
+        return 0;
+    }
+    if (mode == "--bench-cache") {
+        int processes = intArg(2, 64), resources = intArg(3, 8), ops = intArg(4, 50000), capacity = intArg(5, 4096);
+        if (processes <= 0 || resources <= 0 || ops <= 0 || capacity <= 0) { printUsage(argv[0]); return 1; }
+        runVerdictCacheBenchmark(processes, resources, ops, capacity);
+        return 0;
+    }
+    if (mode == "--bench-detect") {
+        int processes = intArg(2, 64), resources = intArg(3, 8), trials = intArg(4, 200);
+        if (processes <= 0 || resources <= 0 || trials <= 0) { printUsage(argv[0]); return 1; }
+        runDetectionComparison(processes, resources, trials);
+        return 0;
+    }
+    if (mode == "--bench-journal") {
+        string directory = argc > 2 ? argv[2] : "journal_bench";
+        int processes = intArg(3, 64), resources = intArg(4, 8), ops = intArg(5, 200000), threads = intArg(6, 8);
+        if (processes <= 0 || resources <= 0 || ops <= 0 || threads <= 0) { printUsage(argv[0]); return 1; }
+        runJournalBenchmark(directory, processes, resources, ops, threads);
+        return 0;
+    }
+    if (mode == "--distributed") {
+        int processes = intArg(2, 256), resources = intArg(3, 256), trials = intArg(4, 20);
+        int delay = intArg(5, 50), maxNodes = intArg(6, 16);
+        if (processes <= 0 || resources <= 0 || trials <= 0 || delay < 0 || maxNodes <= 0) { printUsage(argv[0]); return 1; }
+        runDistributedDetectionBenchmark(processes, resources, trials, delay, maxNodes);
+        return 0;
+    }
+    if (mode == "--monitor") {
+        int processes = intArg(2, 256), resources = intArg(3, 8), tickUs = intArg(5, 1000);
+        double seconds = argc > 4 ? atof(argv[4]) : 1.0, sloMs = argc > 6 ? atof(argv[6]) : 10.0;
+        if (processes <= 0 || resources <= 0 || seconds <= 0 || tickUs <= 0 || sloMs <= 0) { printUsage(argv[0]); return 1; }
+        runMonitorBenchmark(processes, resources, seconds, tickUs, sloMs);
+        return 0;
+    }
+    if (mode == "--fuzz") {
+        int iterations = intArg(2, 2000), seed = intArg(3, 1);
+        if (iterations <= 0) { printUsage(argv[0]); return 1; }
+        return runFuzzHarness(iterations, (unsigned)seed) == 0 ? 0 : 1;
+    }
+#ifdef __linux__
+    if (mode == "--serve" && argc > 2) {
+        runAdmissionServer(argv[2], intArg(3, 0), intArg(4, 0), argc > 5 ? argv[5] : "");
+        return 0;
+    }
+    if (mode == "--loadgen" && argc > 2) {
+        int clients = intArg(3, 4), ops = intArg(4, 50000), depth = intArg(5, 16);
+        if (clients <= 0 || ops <= 0 || depth <= 0) { printUsage(argv[0]); return 1; }
+        runLoadGenerator(argv[2], clients, ops, depth);
+        return 0;
+    }
+#endif
+
+    printUsage(argv[0]);
+    return mode == "--help" ? 0 : 1;
 }
 
 // Main function: Program entry point and control flow
-int main() {
+int main(int argc, char* argv[]) {
+    if (argc > 1) return runCommandLineMode(argc, argv);
+
+
     DeadlockDetector detector;          // Create detector instance
     char choice;                        // User menu choice
     bool deadlockDetected = false;      // Track deadlock status
@@ -835,6 +4876,9 @@ int main() {
             case '4':
                 threadDeadlockMenu();
                 continue;
+            case '5':
+                cout << "\n" << metricsRegistry().report(false);
+                continue;
             case '0':
                 return 0;
             default:
@@ -859,6 +4903,9 @@ int main() {
                 case '2':
                     deadlockDetected = !detector.waitForGraphDetection();
                     break;
+                case '3':
+                    deadlockDetected = !detector.requestMatrixDetection();
+                    break;
                 default:
                     cout << "\n[ERROR] Invalid choice! Please try again.\n";
                     continue;